@@ -12,6 +12,8 @@
 #include "file.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "x86.h"
 
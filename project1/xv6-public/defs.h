@@ -5,9 +5,14 @@ struct inode;
 struct pipe;
 struct proc;
 struct rtcdate;
+struct rusage;
+struct schedstat;
+struct mlfqpolicy;
 struct spinlock;
 struct sleeplock;
 struct stat;
+struct timer;
+struct traceev;
 struct superblock;
 
 // bio.c
@@ -78,6 +83,8 @@ int             lapicid(void);
 extern volatile uint*    lapic;
 void            lapiceoi(void);
 void            lapicinit(void);
+void            lapicipi(int, int);
+void            lapictimer(int);
 void            lapicstartap(uchar, uint);
 void            microdelay(int);
 
@@ -119,14 +126,28 @@ void            sleep(void*, struct spinlock*);
 void            userinit(void);
 int             wait(void);
 void            wakeup(void*);
-void            priority_boosting();
+void            priority_boosting(void);
 void            yield(void);
 extern uint     global_ticks;
-extern uint     MLFQ_order[3];
+extern uint     MLFQ_order[];
+extern struct mlfqpolicy mlfq;
 int             getLevel(void);
 void            setPriority(int pid, int priority);
 void            schedulerLock(int password);
 void            schedulerUnlock(int password);
+void            account_demote(struct proc*);
+void            getschedstat(struct schedstat*);
+int             getrusage(int, struct rusage*);
+int             settickets(int, int);
+int             setstrideshare(int);
+int             sched_setaffinity(int, uint);
+int             sched_getaffinity(int);
+int             mlfqpolicy(struct mlfqpolicy*, struct mlfqpolicy*);
+int             sched_setrt(int, int);
+int             yield_to(int);
+void            rt_charge(struct proc*);
+void            inherit_priority(struct sleeplock*);
+void            restore_priority(void);
 
 // swtch.S
 void            swtch(struct context**, struct context*);
@@ -165,6 +186,14 @@ void            syscall(void);
 
 // timer.c
 void            timerinit(void);
+void            timer_add(struct timer*, uint, void (*)(void*), void*);
+void            timer_del(struct timer*);
+void            timer_expire(void);
+
+// trace.c
+void            traceinit(void);
+void            trace(int, struct proc*);
+int             gettrace(struct traceev*, int);
 
 // trap.c
 void            idtinit(void);
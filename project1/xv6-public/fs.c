@@ -14,6 +14,8 @@
 #include "param.h"
 #include "stat.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "spinlock.h"
 #include "sleeplock.h"
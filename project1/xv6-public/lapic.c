@@ -41,6 +41,8 @@
 #define TCCR    (0x0390/4)   // Timer Current Count
 #define TDCR    (0x03E0/4)   // Timer Divide Configuration
 
+#define TCOUNT  10000000     // Timer initial count (one tick)
+
 volatile uint *lapic;  // Initialized in mp.c
 
 //PAGEBREAK!
@@ -66,7 +68,7 @@ lapicinit(void)
   // TICR would be calibrated using an external time source.
   lapicw(TDCR, X1);
   lapicw(TIMER, PERIODIC | (T_IRQ0 + IRQ_TIMER));
-  lapicw(TICR, 10000000);
+  lapicw(TICR, TCOUNT);
 
   // Disable logical interrupt lines.
   lapicw(LINT0, MASKED);
@@ -113,6 +115,27 @@ lapiceoi(void)
     lapicw(EOI, 0);
 }
 
+// 이 cpu의 periodic timer를 켜거나 끄는 함수
+// 할 일이 없어 멈춰 있는 동안 timer interrupt로 깨어나지 않도록 끔
+void
+lapictimer(int on)
+{
+  if(lapic)
+    lapicw(TICR, on ? TCOUNT : 0);
+}
+
+// apicid cpu에게 vector interrupt를 보내는 함수
+void
+lapicipi(int apicid, int vector)
+{
+  if(!lapic)
+    return;
+  lapicw(ICRHI, apicid<<24);
+  lapicw(ICRLO, FIXED | ASSERT | vector);
+  while(lapic[ICRLO] & DELIVS)
+    ;
+}
+
 // Spin for a given number of microseconds.
 // On real hardware would want to tune this dynamically.
 void
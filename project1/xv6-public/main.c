@@ -3,6 +3,8 @@
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "x86.h"
 
@@ -27,6 +29,7 @@ main(void)
   consoleinit();   // console hardware
   uartinit();      // serial port
   pinit();         // process table
+  traceinit();     // context switch trace
   tvinit();        // trap vectors
   binit();         // buffer cache
   fileinit();      // file table
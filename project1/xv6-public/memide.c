@@ -5,6 +5,8 @@
 #include "defs.h"
 #include "param.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "x86.h"
 #include "traps.h"
@@ -0,0 +1,13 @@
+// MLFQ scheduler의 policy table
+// mlfqpolicy() system call로 실행 중에 읽고 바꿀 수 있음
+
+#define MAXLEVEL 8               // 최대 queue level 수
+#define MAXPRIO  8               // 마지막 level에서 쓸 수 있는 최대 priority 수
+
+struct mlfqpolicy {
+  int nlevel;                    // queue level 수 (1 ~ MAXLEVEL), 마지막 level은 priority 순으로 고름
+  int quantum[MAXLEVEL];         // level별 time quantum (tick), 다 쓰면 아래 level로 내려감
+  int nprio;                     // 마지막 level의 priority 수 (1 ~ MAXPRIO), 0이 가장 먼저 실행됨
+  int boost;                     // priority boosting 주기 (tick), 0이면 boosting 하지 않음
+  int aging;                     // 마지막 level에서 quantum을 다 쓸 때마다 priority를 줄이는 양
+};
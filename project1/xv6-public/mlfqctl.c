@@ -0,0 +1,88 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "mlfq.h"
+
+// 사용법: mlfqctl [-q quantum,quantum,...] [-p nprio] [-b boost] [-a aging]
+// 인자 없이 실행하면 현재 MLFQ policy를 출력
+// -q로 준 quantum의 개수가 level 수가 되고, 주지 않은 값은 그대로 유지됨
+
+void
+usage(void)
+{
+  printf(2, "usage: mlfqctl [-q quantum,quantum,...] [-p nprio] [-b boost] [-a aging]\n");
+  exit();
+}
+
+// "4,6,8" 형식의 quantum 목록을 pol에 채우는 함수
+int
+parsequantum(char *s, struct mlfqpolicy *pol)
+{
+  int n = 0;
+
+  while(*s){
+    if(n == MAXLEVEL)
+      return -1;
+    pol->quantum[n++] = atoi(s);
+    while(*s && *s != ',')
+      s++;
+    if(*s == ',')
+      s++;
+  }
+  pol->nlevel = n;
+  return 0;
+}
+
+void
+print(struct mlfqpolicy *pol)
+{
+  int i;
+
+  printf(1, "levels: %d, quantum:", pol->nlevel);
+  for(i = 0; i < pol->nlevel; i++)
+    printf(1, " %d", pol->quantum[i]);
+  printf(1, "\npriorities: %d, boost: %d, aging: %d\n", pol->nprio, pol->boost, pol->aging);
+}
+
+int
+main(int argc, char *argv[])
+{
+  struct mlfqpolicy pol;
+  int i;
+
+  if(mlfqpolicy(0, &pol) < 0){
+    printf(2, "mlfqctl: mlfqpolicy failed\n");
+    exit();
+  }
+  if(argc == 1){
+    print(&pol);
+    exit();
+  }
+  for(i = 1; i < argc; i += 2){
+    if(argv[i][0] != '-' || i + 1 >= argc)
+      usage();
+    switch(argv[i][1]){
+    case 'q':
+      if(parsequantum(argv[i+1], &pol) < 0)
+        usage();
+      break;
+    case 'p':
+      pol.nprio = atoi(argv[i+1]);
+      break;
+    case 'b':
+      pol.boost = atoi(argv[i+1]);
+      break;
+    case 'a':
+      pol.aging = atoi(argv[i+1]);
+      break;
+    default:
+      usage();
+    }
+  }
+  if(mlfqpolicy(&pol, 0) < 0){
+    printf(2, "mlfqctl: invalid policy\n");
+    exit();
+  }
+  print(&pol);
+  exit();
+}
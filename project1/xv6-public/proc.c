@@ -4,24 +4,541 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "x86.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "sleeplock.h"
+#include "traps.h"
+#include "schedstat.h"
+#include "timer.h"
+#include "trace.h"
 
 struct {
   struct spinlock lock;
   struct proc proc[NPROC];
+  struct proc *waitq[NWAITQ];  // chan으로 hash한 sleeping process들의 wait queue
 } ptable;
 
 static struct proc *initproc;
 
+// chan이 속한 wait queue의 head를 반환하는 함수
+static struct proc**
+waitq(void *chan)
+{
+  return &ptable.waitq[(uint)chan % NWAITQ];
+}
+
+// SLEEPING이 되는 p를 p->chan의 wait queue에 넣는 함수
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+waitq_insert(struct proc *p)
+{
+  struct proc **head = waitq(p->chan);
+
+  p->wq_prev = 0;
+  p->wq_next = *head;
+  if(*head)
+    (*head)->wq_prev = p;
+  *head = p;
+}
+
+// 더 이상 SLEEPING이 아닌 p를 wait queue에서 빼는 함수
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+waitq_remove(struct proc *p)
+{
+  if(p->wq_prev)
+    p->wq_prev->wq_next = p->wq_next;
+  else
+    *waitq(p->chan) = p->wq_next;
+  if(p->wq_next)
+    p->wq_next->wq_prev = p->wq_prev;
+  p->wq_next = 0;
+  p->wq_prev = 0;
+}
+
+// level별 대기 시간 histogram과 전체 횟수, ptable.lock으로 보호
+static struct {
+  uint hist[MAXLEVEL][NSCHEDHIST];
+  uint ndispatch[MAXLEVEL];
+  uint ndemote;
+  uint nboost;
+} sstat;
+
+// 현재 MLFQ policy, ptable.lock으로 보호
+// 기본값은 L0, L1, L2의 3 level, time quantum 2*n + 4, L2 priority 0~3, 100 tick마다 boosting
+struct mlfqpolicy mlfq = {
+  .nlevel = 3,
+  .quantum = {4, 6, 8},
+  .nprio = 4,
+  .boost = 100,
+  .aging = 1,
+};
+
 uint global_ticks = 0;
-uint MLFQ_order[3] = {1,1,1};
+uint MLFQ_order[MAXLEVEL] = {1,1,1,1,1,1,1,1};
 int nextpid = 1;
 extern void forkret(void);
 extern void trapret(void);
 
 static void wakeup1(void *chan);
 
+// src의 CPU 사용량을 dst에 더하는 함수
+static void
+ruadd(struct rusage *dst, struct rusage *src)
+{
+  dst->utime += src->utime;
+  dst->stime += src->stime;
+  dst->nvcsw += src->nvcsw;
+  dst->nivcsw += src->nivcsw;
+  dst->nfault += src->nfault;
+}
+
+// policy가 바뀌어 범위를 벗어난 q_level과 priority를 마지막 level, 가장 낮은 priority로 맞추는 함수
+static void
+mlfq_clamp(struct proc *p)
+{
+  if(p->q_level > mlfq.nlevel - 1)
+    p->q_level = mlfq.nlevel - 1;
+  if(p->priority > mlfq.nprio - 1)
+    p->priority = mlfq.nprio - 1;
+  if(p->pi_rank > mlfq.nlevel + mlfq.nprio - 1)
+    p->pi_rank = mlfq.nlevel + mlfq.nprio - 1;
+}
+
+// process 자신의 queue level과 priority로 정해지는 run queue 번호
+// (마지막을 뺀 level n -> n + 1, 마지막 level -> nlevel + priority)
+static int
+mlfq_rank(struct proc *p)
+{
+  if(p->q_level < mlfq.nlevel - 1)   // 마지막 level이 아니라면
+    return p->q_level + 1;
+  return mlfq.nlevel + p->priority;  // 마지막 level은 priority마다 queue를 따로 둠
+}
+
+// 빌려받은 것까지 포함해 process가 실제로 들어갈 MLFQ run queue 번호 (작을수록 먼저 실행됨)
+static int
+effective_rank(struct proc *p)
+{
+  int rank = mlfq_rank(p);
+
+  if(p->pi_rank && p->pi_rank < rank)
+    rank = p->pi_rank;
+  return rank;
+}
+
+// process가 들어갈 run queue 번호를 구하는 함수 (schedulerLock -> 0)
+static int
+runq_index(struct proc *p)
+{
+  if(p->qualification)               // scheduler lock이 걸린 process라면
+    return 0;                        // 가장 먼저 확인하는 queue
+  return effective_rank(p);
+}
+
+// p를 p->rq_cpu의 MLFQ run queue에 넣는 함수
+// queue 안은 order 순으로 정렬되어 있고, 대부분 맨 뒤에 들어가므로 뒤에서부터 찾음
+static void
+runq_insert(struct proc *p)
+{
+  struct cpu *c = p->rq_cpu;
+  int i;
+  struct proc *q;
+
+  mlfq_clamp(p);
+  i = runq_index(p);
+  for(q = c->rq_tail[i]; q && q->order > p->order; q = q->rq_prev)
+    ;                                      // p보다 order가 크지 않은 process를 찾음
+  p->rq_prev = q;
+  if(q){                                   // q 뒤에 넣음
+    p->rq_next = q->rq_next;
+    q->rq_next = p;
+  } else {                                 // queue의 맨 앞에 넣음
+    p->rq_next = c->rq_head[i];
+    c->rq_head[i] = p;
+  }
+  if(p->rq_next)
+    p->rq_next->rq_prev = p;
+  else
+    c->rq_tail[i] = p;
+}
+
+// p를 p->rq_cpu의 MLFQ run queue에서 빼는 함수
+static void
+runq_remove(struct proc *p)
+{
+  struct cpu *c = p->rq_cpu;
+  int i = runq_index(p);
+
+  if(p->rq_prev)
+    p->rq_prev->rq_next = p->rq_next;
+  else
+    c->rq_head[i] = p->rq_next;
+  if(p->rq_next)
+    p->rq_next->rq_prev = p->rq_prev;
+  else
+    c->rq_tail[i] = p->rq_prev;
+  p->rq_next = 0;
+  p->rq_prev = 0;
+}
+
+// pass 값 비교 (overflow가 나도 순서가 유지되도록 차이로 비교)
+#define PASS_LT(a, b) ((int)((a) - (b)) < 0)
+
+// stride_heap의 i번째와 j번째 process를 바꾸는 함수
+static void
+heap_swap(struct cpu *c, int i, int j)
+{
+  struct proc *t = c->stride_heap[i];
+
+  c->stride_heap[i] = c->stride_heap[j];
+  c->stride_heap[j] = t;
+  c->stride_heap[i]->heap_idx = i;
+  c->stride_heap[j]->heap_idx = j;
+}
+
+// i번째 process를 pass가 부모보다 작은 동안 위로 올리는 함수
+static void
+heap_up(struct cpu *c, int i)
+{
+  while(i > 0 && PASS_LT(c->stride_heap[i]->pass, c->stride_heap[(i-1)/2]->pass)){
+    heap_swap(c, i, (i-1)/2);
+    i = (i-1)/2;
+  }
+}
+
+// i번째 process를 pass가 자식보다 큰 동안 아래로 내리는 함수
+static void
+heap_down(struct cpu *c, int i)
+{
+  int l, r, m;
+
+  for(;;){
+    l = 2*i + 1;
+    r = l + 1;
+    m = i;
+    if(l < c->nstride && PASS_LT(c->stride_heap[l]->pass, c->stride_heap[m]->pass))
+      m = l;
+    if(r < c->nstride && PASS_LT(c->stride_heap[r]->pass, c->stride_heap[m]->pass))
+      m = r;
+    if(m == i)
+      break;
+    heap_swap(c, i, m);
+    i = m;
+  }
+}
+
+// stride process p를 p->rq_cpu의 stride_heap에 넣는 함수
+// 쉬고 있던 동안의 pass를 몰아서 쓰지 못하도록 최소 stride_vtime부터 시작함
+static void
+heap_push(struct proc *p)
+{
+  struct cpu *c = p->rq_cpu;
+
+  if(PASS_LT(p->pass, c->stride_vtime))
+    p->pass = c->stride_vtime;
+  c->stride_heap[c->nstride] = p;
+  p->heap_idx = c->nstride++;
+  heap_up(c, p->heap_idx);
+}
+
+// stride process p를 p->rq_cpu의 stride_heap에서 빼는 함수
+static void
+heap_remove(struct proc *p)
+{
+  struct cpu *c = p->rq_cpu;
+  int i = p->heap_idx;
+
+  c->nstride--;
+  if(i != c->nstride){                     // 마지막 process를 빈 자리로 옮기고 위치를 맞춤
+    c->stride_heap[i] = c->stride_heap[c->nstride];
+    c->stride_heap[i]->heap_idx = i;
+    heap_up(c, i);
+    heap_down(c, c->stride_heap[i]->heap_idx);
+  }
+  p->heap_idx = -1;
+}
+
+// real-time class로 실행되는 process인지 (budget을 다 쓴 동안은 MLFQ class로 실행됨)
+static int
+rt_class(struct proc *p)
+{
+  return p->rt_period && !p->rt_throttled;
+}
+
+// real-time process p를 p->rq_cpu의 rt queue에 deadline 순으로 넣는 함수
+static void
+rt_insert(struct proc *p)
+{
+  struct cpu *c = p->rq_cpu;
+  struct proc *q, *prev = 0;
+
+  for(q = c->rt_head; q && !PASS_LT(p->rt_deadline, q->rt_deadline); q = q->rq_next)
+    prev = q;                              // deadline이 같으면 먼저 들어온 process가 앞
+  p->rq_prev = prev;
+  p->rq_next = q;
+  if(prev)
+    prev->rq_next = p;
+  else
+    c->rt_head = p;
+  if(q)
+    q->rq_prev = p;
+}
+
+// real-time process p를 p->rq_cpu의 rt queue에서 빼는 함수
+static void
+rt_remove(struct proc *p)
+{
+  if(p->rq_prev)
+    p->rq_prev->rq_next = p->rq_next;
+  else
+    p->rq_cpu->rt_head = p->rq_next;
+  if(p->rq_next)
+    p->rq_next->rq_prev = p->rq_prev;
+  p->rq_next = 0;
+  p->rq_prev = 0;
+}
+
+// RUNNABLE이 된 process를 p->rq_cpu의 run queue에 넣는 함수
+// real-time process는 rt queue에, ticket이 있는 process는 stride_heap에, 나머지는 MLFQ run queue에 넣음
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+enqueue(struct proc *p)
+{
+  if(rt_class(p))
+    rt_insert(p);
+  else if(p->tickets && !p->qualification)
+    heap_push(p);
+  else
+    runq_insert(p);
+  p->rq_cpu->nrunnable++;
+}
+
+// run queue에서 process를 빼는 함수
+// q_level, priority, qualification, tickets, rt_deadline, rt_throttled, rq_cpu를 바꾸기 전에 호출해야 함
+static void
+dequeue(struct proc *p)
+{
+  if(p->heap_idx >= 0)
+    heap_remove(p);
+  else if(rt_class(p))
+    rt_remove(p);
+  else
+    runq_remove(p);
+  p->rq_cpu->nrunnable--;
+}
+
+// stride class가 가져가는 CPU 비율 (%), 나머지는 MLFQ class가 가져감
+int stride_share = 50;
+
+// cpu c의 MLFQ run queue에서 다음에 실행될 process를 찾는 함수
+// 앞 번호의 queue일수록 우선순위가 높으므로 처음으로 비어있지 않은 queue의 맨 앞을 반환
+static struct proc*
+mlfq_head(struct cpu *c)
+{
+  int i;
+
+  for(i = 0; i < NRUNQ; i++)
+    if(c->rq_head[i])
+      return c->rq_head[i];
+  return 0;
+}
+
+// cpu c에서 다음에 실행될 process를 찾는 함수
+// deadline이 가장 빠른 real-time process가 가장 먼저이고, 그 다음이 schedulerLock이 걸린 process,
+// 그 외에는 stride와 MLFQ 두 class 중 pass가 작은 쪽을 고름
+static struct proc*
+pick_next(struct cpu *c)
+{
+  struct proc *mlfq;
+
+  if(c->rt_head)
+    return c->rt_head;
+  mlfq = mlfq_head(c);
+  if(c->rq_head[0] || c->nstride == 0)     // schedulerLock이 걸렸거나 stride process가 없다면
+    return mlfq;
+  if(mlfq == 0 || PASS_LT(c->stride_pass, c->mlfq_pass))
+    return c->stride_heap[0];              // pass가 가장 작은 stride process
+  return mlfq;
+}
+
+// cpu c에서 process가 dispatch 될 때 그 class의 pass를 늘리는 함수
+// 다른 class가 비어있으면 그 class가 나중에 몰아서 실행되지 않도록 pass를 맞춰줌
+static void
+charge_class(struct cpu *c, struct proc *p, int is_stride)
+{
+  if(is_stride){
+    c->stride_vtime = p->pass;
+    p->pass += p->stride;
+    c->stride_pass += STRIDE1 / stride_share;
+    if(mlfq_head(c) == 0 && PASS_LT(c->mlfq_pass, c->stride_pass))
+      c->mlfq_pass = c->stride_pass;
+  } else {
+    c->mlfq_pass += STRIDE1 / (100 - stride_share);
+    if(c->nstride == 0 && PASS_LT(c->stride_pass, c->mlfq_pass))
+      c->stride_pass = c->mlfq_pass;
+  }
+}
+
+// cpu의 부하 (기다리는 process 수 + 실행 중인 process)
+static int
+cpu_load(struct cpu *c)
+{
+  return c->nrunnable + (c->proc != 0);
+}
+
+// process p가 cpu c에서 실행될 수 있는지 (affinity mask 확인)
+// real-time process는 admission 된 cpu에서만 실행됨
+static int
+allowed(struct proc *p, struct cpu *c)
+{
+  if(p->rt_period)
+    return c == p->rt_cpu;
+  return (p->cpumask >> (c - cpus)) & 1;
+}
+
+// RUNNABLE이 될 process를 넣을 cpu를 고르는 함수
+// 마지막으로 실행된 cpu가 비어있으면 cache를 위해 그대로 두고, 아니면 가장 한가한 cpu를 고름
+// affinity mask에 없는 cpu는 고르지 않음
+static struct cpu*
+pick_cpu(struct proc *p)
+{
+  struct cpu *c;
+  struct cpu *best = p->rq_cpu;
+
+  if(best && !allowed(p, best))
+    best = 0;
+  if(best && cpu_load(best) == 0)
+    return best;
+  for(c = cpus; c < &cpus[ncpu]; c++)
+    if(allowed(p, c) && (!best || cpu_load(c) < cpu_load(best)))
+      best = c;
+  return best;
+}
+
+// cpu c의 run queue에 process가 들어왔을 때 멈춰 있는 cpu를 깨우는 함수
+// c가 멈춰 있으면 c를 깨우고, c에 기다리는 process가 쌓여 있으면 다른 cpu를 깨워 가져가게 함
+static void
+kick(struct cpu *c)
+{
+  struct cpu *v;
+
+  if(c->idle){
+    if(c != mycpu())
+      lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+    return;
+  }
+  if(c->nrunnable < 2)
+    return;
+  for(v = cpus; v < &cpus[ncpu]; v++){
+    if(v->idle && v != mycpu()){
+      lapicipi(v->apicid, T_IRQ0 + IRQ_WAKEUP);
+      return;
+    }
+  }
+}
+
+// 대기 시간 wait가 들어갈 histogram 칸 (0, 1, 2~3, 4~7, ...)
+static int
+hist_index(uint wait)
+{
+  int i = 0;
+
+  while(wait && i < NSCHEDHIST - 1){
+    wait >>= 1;
+    i++;
+  }
+  return i;
+}
+
+// dispatch 되는 process의 대기 시간을 기록하는 함수
+// histogram은 MLFQ class process만 기록함
+static void
+account_dispatch(struct proc *p, int is_mlfq)
+{
+  uint wait = ticks - p->enq_tick;
+
+  p->wait_ticks[p->q_level] += wait;
+  p->ndispatch++;
+  if(!is_mlfq)
+    return;
+  sstat.hist[p->q_level][hist_index(wait)]++;
+  sstat.ndispatch[p->q_level]++;
+}
+
+// 현재 process가 quantum을 다 써서 아래 level로 내려갔음을 기록하는 함수
+void
+account_demote(struct proc *p)
+{
+  acquire(&ptable.lock);
+  p->ndemote++;
+  sstat.ndemote++;
+  release(&ptable.lock);
+}
+
+// process를 고른 cpu의 run queue에 넣는 함수
+static void
+make_runnable(struct proc *p)
+{
+  p->state = RUNNABLE;
+  p->enq_tick = ticks;
+  p->rq_cpu = pick_cpu(p);
+  enqueue(p);
+  kick(p->rq_cpu);
+}
+
+// cpu v의 run queue에서 cpu c가 가져갈 수 있는 process를 찾는 함수
+// v에서 다음에 실행될 process를 먼저 보고, affinity 때문에 안 되면
+// MLFQ queue 순서대로, 그 다음 stride_heap에서 pass가 가장 작은 process를 찾음
+static struct proc*
+steal_candidate(struct cpu *v, struct cpu *c)
+{
+  struct proc *p, *best = 0;
+  int i;
+
+  p = pick_next(v);
+  if(p == 0 || allowed(p, c))
+    return p;
+  for(i = 0; i < NRUNQ; i++)
+    for(p = v->rq_head[i]; p; p = p->rq_next)
+      if(allowed(p, c))
+        return p;
+  for(i = 0; i < v->nstride; i++){
+    p = v->stride_heap[i];
+    if(allowed(p, c) && (!best || PASS_LT(p->pass, best->pass)))
+      best = p;
+  }
+  return best;
+}
+
+// 할 일이 없는 cpu c가 가장 바쁜 cpu의 run queue에서 process를 가져오는 함수
+// 가져오는 process는 그 cpu에서 다음에 실행될 process이므로 L0, L1, L2 순서를 지킴
+// c에서 실행될 수 없는 process는 가져오지 않음
+static struct proc*
+steal(struct cpu *c)
+{
+  struct cpu *v;
+  struct proc *p = 0;
+  struct proc *q;
+  int load = 0;
+
+  for(v = cpus; v < &cpus[ncpu]; v++){
+    if(v == c || v->nrunnable <= load)
+      continue;
+    if((q = steal_candidate(v, c)) != 0){
+      p = q;
+      load = v->nrunnable;
+    }
+  }
+  if(p == 0)
+    return 0;
+  dequeue(p);
+  p->rq_cpu = c;
+  enqueue(p);
+  return p;
+}
+
 void
 pinit(void)
 {
@@ -35,35 +552,26 @@ cpuid() {
 }
 
 // Must be called with interrupts disabled to avoid the caller being
-// rescheduled between reading lapicid and running through the loop.
+// rescheduled to another cpu while using the result.
+// seginit()에서 %gs에 잡아둔 per-CPU segment에서 한 번에 읽음
 struct cpu*
 mycpu(void)
 {
-  int apicid, i;
-  
+  struct cpu *c;
+
   if(readeflags()&FL_IF)
     panic("mycpu called with interrupts enabled\n");
-  
-  apicid = lapicid();
-  // APIC IDs are not guaranteed to be contiguous. Maybe we should have
-  // a reverse map, or reserve a register to store &cpus[i].
-  for (i = 0; i < ncpu; ++i) {
-    if (cpus[i].apicid == apicid)
-      return &cpus[i];
-  }
-  panic("unknown apicid\n");
+  asm volatile("movl %%gs:0, %0" : "=r" (c));
+  return c;
 }
 
-// Disable interrupts so that we are not rescheduled
-// while reading proc from the cpu structure
+// 현재 cpu의 proc을 명령어 하나로 읽으므로 interrupt를 끌 필요가 없음
+// (읽은 뒤 다른 cpu로 옮겨져도 그 cpu의 proc은 여전히 이 process임)
 struct proc*
 myproc(void) {
-  struct cpu *c;
   struct proc *p;
-  pushcli();
-  c = mycpu();
-  p = c->proc;
-  popcli();
+
+  asm volatile("movl %%gs:4, %0" : "=r" (p));
   return p;
 }
 
@@ -92,10 +600,29 @@ found:
   p->pid = nextpid++;
   p->q_level = 0;
   p->t_quantum = 0;
-  p->priority = 3;
+  p->priority = mlfq.nprio - 1;
   p->order = MLFQ_order[0]++;
-  p->boosting_tmp = 0;
   p->qualification = 0;
+  p->rq_cpu = 0;
+  memset(p->run_ticks, 0, sizeof(p->run_ticks));
+  memset(p->wait_ticks, 0, sizeof(p->wait_ticks));
+  p->ndispatch = 0;
+  p->ndemote = 0;
+  p->nboost = 0;
+  p->tickets = 0;
+  p->stride = 0;
+  p->pass = 0;
+  p->heap_idx = -1;
+  p->cpumask = ~0;
+  p->rt_period = 0;
+  p->rt_throttled = 0;
+  p->rt_cpu = 0;
+  p->pi_rank = 0;
+  p->pi_wait = 0;
+  p->nsleeplock = 0;
+  memset(&p->ru, 0, sizeof(p->ru));
+  p->preempted = 0;
+  memset(&p->cru, 0, sizeof(p->cru));
 
   release(&ptable.lock);
 
@@ -156,7 +683,7 @@ userinit(void)
   // because the assignment might not be atomic.
   acquire(&ptable.lock);
 
-  p->state = RUNNABLE;
+  make_runnable(p);
 
   release(&ptable.lock);
 }
@@ -218,11 +745,15 @@ fork(void)
 
   safestrcpy(np->name, curproc->name, sizeof(curproc->name));
 
+  np->tickets = curproc->tickets;  // stride class라면 같은 ticket 수를 물려받음
+  np->stride = curproc->stride;
+  np->cpumask = curproc->cpumask;  // affinity mask를 물려받음
+
   pid = np->pid;
 
   acquire(&ptable.lock);
 
-  np->state = RUNNABLE;
+  make_runnable(np);
 
   release(&ptable.lock);
 
@@ -242,6 +773,8 @@ exit(void)
   if(curproc == initproc)
     panic("init exiting");
 
+  sched_setrt(0, 0);   // real-time class였다면 admission 된 이용률을 돌려주고 replenish timer를 멈춤
+
   // Close all open files.
   for(fd = 0; fd < NOFILE; fd++){
     if(curproc->ofile[fd]){
@@ -295,6 +828,8 @@ wait(void)
       if(p->state == ZOMBIE){
         // Found one.
         pid = p->pid;
+        ruadd(&curproc->cru, &p->ru);   // 자식과 자식이 회수한 자손들의 사용량을 더함
+        ruadd(&curproc->cru, &p->cru);
         kfree(p->kstack);
         p->kstack = 0;
         freevm(p->pgdir);
@@ -319,6 +854,53 @@ wait(void)
   }
 }
 
+// 실행할 process가 없을 때 interrupt가 올 때까지 cpu c를 멈추는 함수
+// ptable.lock을 잡은 상태로 호출하며, lock을 놓고 돌아옴
+// cpu 0은 ticks를 세야 하므로 timer를 그대로 두고, 나머지 cpu는 멈춰 있는 동안 timer를 끔
+static void
+idle(struct cpu *c)
+{
+  int tickless = cpuid() != 0;
+
+  c->idle = 1;
+  c->intena = 0;          // release()가 interrupt를 켜지 않게 해서 hlt 전에 온 IPI를 놓치지 않음
+  release(&ptable.lock);
+  if(tickless)
+    lapictimer(0);
+  stihlt();               // interrupt나 다른 cpu의 IPI가 올 때까지 멈춤
+  if(tickless)
+    lapictimer(1);
+  c->idle = 0;
+}
+
+// cpu c에서 다음에 실행될 process를 run queue에서 꺼내 RUNNING으로 만드는 함수
+// yield_to()로 지정된 process가 있으면 그것을, 없으면 run queue의 순서대로 고름
+// 이 cpu에 없으면 가장 바쁜 cpu에서 가져오고, 실행할 process가 없으면 0을 반환
+// page table은 바꾸지 않으므로 호출한 쪽에서 switchuvm()을 해야 함
+// TR_RUN도 호출한 쪽에서 실제로 바뀔 때 기록함
+// ptable.lock을 잡은 상태에서 호출해야 함
+static struct proc*
+dispatch(struct cpu *c)
+{
+  struct proc *p;
+  int is_stride, is_rt;
+
+  if((p = c->handoff) != 0)                     // yield_to()로 지정된 process가 있으면 먼저 실행
+    c->handoff = 0;
+  else if((p = pick_next(c)) == 0 && (p = steal(c)) == 0)
+    return 0;
+  is_stride = p->heap_idx >= 0;                 // stride class에서 고른 process인지
+  is_rt = rt_class(p);                          // real-time class에서 고른 process인지
+  dequeue(p);
+  account_dispatch(p, !is_stride && !is_rt);
+  if(!is_rt)                                    // real-time class는 두 class의 비율과 상관없이 실행됨
+    charge_class(c, p, is_stride);
+  p->rq_cpu = c;
+  c->proc = p;
+  p->state = RUNNING;
+  return p;
+}
+
 //PAGEBREAK: 42
 // Per-CPU process scheduler.
 // Each CPU calls scheduler() after setting itself up.
@@ -327,11 +909,14 @@ wait(void)
 //  - swtch to start running that process
 //  - eventually that process transfers control
 //      via swtch back to the scheduler.
+// 다음에 실행할 process가 있으면 sched()가 scheduler를 거치지 않고 바로 넘어가므로,
+// scheduler로 돌아오는 것은 이 cpu에 실행할 process가 없을 때뿐이고
+// 돌아오는 process가 처음 dispatch 한 process와 다를 수 있음
 void
 scheduler(void)
 {
-  struct proc *p;
   struct cpu *c = mycpu();
+  struct proc *p;
   c->proc = 0;
   
   for(;;){
@@ -340,106 +925,84 @@ scheduler(void)
 
     // Loop over process table looking for process to run.
     acquire(&ptable.lock);
-    struct proc *new_p = 0;                             // 다음 실행될 process를 담는 변수
-    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){ // ptable의 process 처음부터 끝까지 탐색
-      if(p->state != RUNNABLE)                          // RUNNABLE 하지 않다면
-        continue;                                       // 다음 process로 넘어감
-      if(p->qualification){                             // 만약 qualification이 1인 process가 있다면
-        new_p = p;                                      // 실행될 process를 담는 변수에 넣어줌
-        break;                                          // lock이기 때문에 무조건 실행되어야 하므로 break
-      }
-      if(!new_p || new_p->q_level > p->q_level)         // 만약 기존에 아무것도 없었거나, 기존에 있던 process보다 queue level이 낮은 경우
-        new_p = p;                                      // 실행될 process를 담는 변수에 넣어줌
-      else if(new_p->q_level == p->q_level){            // 기존의 process와 queue level이 같은 경우
-        if(p->q_level == 0 || p->q_level == 1)          // L0이나 L1에 있는 process인 경우
-          if(new_p->order > p->order)                   // 현재 queue 안의 order가 더 낮다면
-            new_p = p;                                  // 실행될 process를 담는 변수에 넣어줌
-        if(p->q_level == 2){                            // L2에 있는 process인 경우
-          if(new_p->priority > p->priority)             // priority 값이 더 낮으면
-            new_p = p;                                  // 실행될 process를 담는 변수에 넣어줌
-          else if(new_p->priority == p->priority){      // priority 값이 같다면
-            if(new_p->order > p->order)                 // 현재 queue 안의 order가 더 낮다면
-              new_p = p;                                // 실행될 process를 담는 변수에 넣어줌
-          }
-        }
-      }
+    if((p = dispatch(c)) == 0){                         // 실행할 process가 하나도 없다면
+      idle(c);                                          // interrupt가 올 때까지 멈춤 (ptable.lock을 놓고 돌아옴)
+      continue;
     }
+    trace(TR_RUN, p);
+
     // Switch to chosen process.  It is the process's job
     // to release ptable.lock and then reacquire it
     // before jumping back to us.
-    if(new_p){
-      c->proc = new_p;
-      switchuvm(new_p);
-      new_p->state = RUNNING;
-
-      swtch(&(c->scheduler), new_p->context);
-      switchkvm();
+    switchuvm(p);
+    swtch(&(c->scheduler), p->context);
+    switchkvm();
 
-      // Process is done running for now.
-      // It should have changed its p->state before coming back.
-      c->proc = 0;
-    }
-    if(global_ticks == 100){ // global_ticks이 100이 되었다면
-      priority_boosting();   // Starvation을 막기 위해 priority boosting
-    }
+    // Process is done running for now.
+    // It should have changed its p->state before coming back.
+    c->proc = 0;
     release(&ptable.lock);
-
   }
 }
 
 // Priority boosting 함수
+// 각 cpu의 run queue를 우선순위 순서(schedulerLock, L0, L1, ..., 마지막 level의 priority 순)대로 이어붙여
+// 하나의 L0 queue로 만들기 때문에 process 수에 비례하는 시간만 걸림
+// timer interrupt에서 global_ticks이 boosting 주기가 되면 호출됨
 void
-priority_boosting()
-{
-  struct proc *p;                                        // process를 찾는 for문을 돌리기 위해 필요한 process를 담는 변수
-  uint now_l0_order = MLFQ_order[0] - 1;                 // 현재 L0이 사용한 order 값
-  int check = 1;                                         // 모든 process가 boosting이 되었는지 check하는 변수
-  while(check){                                          // check가 1인 경우 while문 반복
-    struct proc *tmp = 0;                                // priority boosting 시 순서를 유지하기 위해 다음 순서를 담는 변수
-    check = 0;                                           // check를 0으로 설정
-    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){  // ptable의 process 처음부터 끝까지 탐색
-      if(p->state != RUNNABLE || p->boosting_tmp != 0)   // RUNNABLE 하지 않거나, 이미 boosting 된 대상이면
-        continue;                                        // 다음 process로 넘어감
-      check = 1;                                         // 그렇지 않다면 boosting 대상이 있으므로 check를 1로 바꿈
-      if(p->qualification){                              // 만약 qualification이 1이라면
+priority_boosting(void)
+{
+  struct cpu *c;
+  struct proc *p, *head, *tail;
+  uint order = 1;                                        // boosting 된 process에 1부터 새로 매기는 order
+  int i;
+
+  acquire(&ptable.lock);
+  if(mlfq.boost == 0 || global_ticks < mlfq.boost){     // 다른 cpu가 이미 boosting 했거나 boosting이 꺼졌다면
+    release(&ptable.lock);
+    return;
+  }
+  for(c = cpus; c < &cpus[ncpu]; c++){                   // 모든 cpu의 run queue에 대해
+    head = tail = 0;                                     // 새로 만들 L0 queue
+    for(i = 0; i < NRUNQ; i++){                          // 우선순위가 높은 queue부터
+      if(c->rq_head[i] == 0)                             // 비어있는 queue는 넘어감
+        continue;
+      for(p = c->rq_head[i]; p; p = p->rq_next){         // queue 안의 순서를 유지하면서
         p->qualification = 0;                            // lock을 해제함
-        tmp = p;                                         // 다음 boosting의 대상으로 넣음
-        break;                                           // 가장 먼저 L0에 들어가야 하기 때문에 for문 탈출
-      }
-      if (!tmp || tmp->q_level > p->q_level)             // 만약 기존에 아무것도 없었거나, 기존에 있던 process보다 queue level이 낮은 경우
-        tmp = p;                                         // 다음 boosting의 대상으로 넣음
-      else if (tmp->q_level == p->q_level) {             // 기존의 process와 queue level이 같은 경우
-        if (p->q_level == 0 || p->q_level == 1)          // L0이나 L1에 있는 process인 경우
-          if (tmp->order > p->order)                     // 현재 queue 안의 order가 더 낮다면
-            tmp = p;                                     // 다음 boosting의 대상으로 넣음
-        if (p->q_level == 2) {                           // L2에 있는 process인 경우
-          if (tmp->priority > p->priority)               // priority 값이 더 낮으면
-            tmp = p;                                     // 다음 boosting의 대상으로 넣음
-          else if (tmp->priority == p->priority) {       // priority 값이 같다면
-            if (tmp->order > p->order)                   // 현재 queue 안의 order가 더 낮다면
-              tmp = p;                                   // 다음 boosting의 대상으로 넣음
-          }
-        }
+        p->q_level = 0;                                  // queue level 0으로 초기화
+        p->priority = mlfq.nprio - 1;                    // 가장 낮은 priority로 초기화
+        p->t_quantum = 0;                                // time quantum 0으로 초기화
+        p->order = order++;                              // L0의 다음 순서로 넣음
+        p->nboost++;
       }
+      if(tail){                                          // 새 L0 queue의 뒤에 이어붙임
+        tail->rq_next = c->rq_head[i];
+        c->rq_head[i]->rq_prev = tail;
+      } else
+        head = c->rq_head[i];
+      tail = c->rq_tail[i];
+      c->rq_head[i] = c->rq_tail[i] = 0;
     }
-    if(check == 0)                                       // 더이상 boosting의 대상이 남아있지 않으면(check가 0)
-      break;                                             // while문 탈출
-    tmp->boosting_tmp = MLFQ_order[0]++;                 // boosting의 대상을 L0의 다음 순서로 넣음
-  }
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){    // ptable의 process 처음부터 끝까지 탐색
-    if(p->boosting_tmp == 0)                             // boosting의 대상이 아니면
-      continue;                                          // 다음 process로 넘어감
-    p->q_level = 0;                                      // queue level 0으로 초기화
-    p->priority = 3;                                     // priority 3으로 초기화
-    p->t_quantum = 0;                                    // time quantum 0으로 초기화
-    p->order = p->boosting_tmp - now_l0_order;           // order에 1부터 넣음
-    p->boosting_tmp = 0;                                 // 임시로 순서 담았던 변수 0으로 초기화
-  }
-  MLFQ_order[0] = MLFQ_order[0] - now_l0_order;          // 현재 L0에 있는 개수로 표시
-  MLFQ_order[1] = 1;                                     // L1에는 아무 process도 없으므로 1로 초기화
-  MLFQ_order[2] = 1;                                     // L2에는 아무 process도 없으므로 1로 초기화
+    c->rq_head[1] = head;                                // 1번 run queue가 L0
+    c->rq_tail[1] = tail;
+  }
+  p = myproc();
+  if(p && p->state == RUNNING){                          // timer interrupt로 곧 yield 할 현재 process도
+    p->qualification = 0;                                // 같이 boosting 함
+    p->q_level = 0;
+    p->priority = mlfq.nprio - 1;
+    p->t_quantum = 0;
+    p->nboost++;
+  }
+  sstat.nboost++;
+  trace(TR_BOOST, 0);
+  MLFQ_order[0] = order;                                 // 현재 L0에 있는 개수로 표시
+  for(i = 1; i < MAXLEVEL; i++)                          // 나머지 level에는 아무 process도 없으므로
+    MLFQ_order[i] = 1;                                   // 1로 초기화
   global_ticks = 0;                                      // global_ticks 0으로 초기화
+  release(&ptable.lock);
 }
+
 // Enter scheduler.  Must hold only ptable.lock
 // and have changed proc->state. Saves and restores
 // intena because intena is a property of this
@@ -447,11 +1010,17 @@ priority_boosting()
 // be proc->intena and proc->ncli, but that would
 // break in the few places where a lock is held but
 // there's no process.
+// 다음에 실행할 process가 이미 run queue에 있으면 scheduler를 거치지 않고
+// 그 process로 바로 swtch 하므로 swtch 한 번과 kernel page table 로드를 줄임
+// 자기 자신이 다시 선택되면 (yield 했는데 기다리는 process가 없으면) swtch 하지 않고 돌아감
 void
 sched(void)
 {
   int intena;
   struct proc *p = myproc();
+  struct cpu *c = mycpu();
+  struct proc *next;
+  int preempted;
 
   if(!holding(&ptable.lock))
     panic("sched ptable.lock");
@@ -461,19 +1030,59 @@ sched(void)
     panic("sched running");
   if(readeflags()&FL_IF)
     panic("sched interruptible");
-  intena = mycpu()->intena;
-  swtch(&p->context, mycpu()->scheduler);
+
+  intena = c->intena;
+  preempted = p->preempted;
+  p->preempted = 0;
+  next = dispatch(c);
+  if(next == p)                                 // 다시 자신이 선택되었으면 그대로 계속 실행
+    return;
+
+  // 실제로 다른 process로 바뀔 때만 context switch를 세고 cpu를 내놓는 이유를 기록함
+  if(p->state == SLEEPING){                     // 스스로 잠드는 경우는 자발적인 context switch
+    p->ru.nvcsw++;
+    trace(TR_SLEEP, p);
+  } else if(p->state == ZOMBIE)
+    trace(TR_EXIT, p);
+  else if(preempted){                           // timer에 의한 비자발적인 context switch
+    p->ru.nivcsw++;
+    trace(TR_PREEMPT, p);
+  } else {                                      // 스스로 양보하는 것은 자발적인 context switch
+    p->ru.nvcsw++;
+    trace(TR_YIELD, p);
+  }
+  if(next)
+    trace(TR_RUN, next);
+  if(next){                                     // 다음 process로 바로 넘어감
+    switchuvm(next);
+    c->intena = 1;                              // 처음 실행되는 process는 scheduler에서처럼 forkret에서 interrupt를 켬
+    swtch(&p->context, next->context);
+  } else                                        // 실행할 process가 없으면 scheduler에서 멈춤
+    swtch(&p->context, c->scheduler);
   mycpu()->intena = intena;
 }
 
+// cpu를 내놓는 현재 process p를 RUNNABLE로 바꿔 run queue의 맨 뒤에 다시 넣는 함수
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+requeue(struct proc *p)
+{
+  if (p->q_level < mlfq.nlevel - 1)                     // 마지막 level이 아닌 process일 경우
+    p->order = MLFQ_order[p->q_level]++;                // 그 queue의 마지막 순서로 넣음
+  p->state = RUNNABLE;
+  p->enq_tick = ticks;
+  if(!allowed(p, p->rq_cpu))                            // affinity mask가 바뀌어 이 cpu에서 실행될 수 없다면
+    p->rq_cpu = pick_cpu(p);                            // 실행될 수 있는 cpu로 옮김
+  enqueue(p);                                           // run queue에 다시 넣음
+  kick(p->rq_cpu);                                      // 기다리는 process가 쌓였으면 멈춰 있는 cpu를 깨움
+}
+
 // Give up the CPU for one scheduling round.
 void
 yield(void)
 {
   acquire(&ptable.lock);  //DOC: yieldlock
-  if (myproc()->q_level != 2)                           // L0과 L1에 있는 process일 경우
-    myproc()->order = MLFQ_order[myproc()->q_level]++;  // 그 queue의 마지막 순서로 넣음
-  myproc()->state = RUNNABLE;
+  requeue(myproc());
   sched();
   release(&ptable.lock);
 }
@@ -486,6 +1095,50 @@ sys_yield(void)
   return 0; // 0을 return
 }
 
+// 현재 process의 남은 quantum을 pid process에게 넘겨 바로 실행되게 하고 자신은 yield 하는 함수
+// pid가 RUNNABLE이 아니거나 이 cpu에서 실행될 수 없으면 -1을 반환
+// 이 cpu에 real-time process나 schedulerLock을 건 process가 기다리고 있으면 그 순서를 지켜 보통의 yield처럼 동작함
+int
+yield_to(int pid)
+{
+  struct proc *p;
+  struct proc *curproc = myproc();
+  struct cpu *c;
+
+  acquire(&ptable.lock);
+  c = mycpu();
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    if(p->pid == pid && p->state != UNUSED)
+      break;
+  if(p == &ptable.proc[NPROC] || p == curproc || p->state != RUNNABLE || !allowed(p, c)){
+    release(&ptable.lock);
+    return -1;
+  }
+  if(c->rt_head == 0 && c->rq_head[0] == 0){            // 먼저 실행되어야 하는 process가 없다면
+    if(p->rq_cpu != c){                                 // 다른 cpu의 run queue에 있으면 이 cpu로 가져옴
+      dequeue(p);
+      p->rq_cpu = c;
+      enqueue(p);
+    }
+    c->handoff = p;                                     // sched()에서 p로 바로 넘어감
+  }
+  requeue(curproc);
+  sched();
+  release(&ptable.lock);
+  return 0;
+}
+
+// yield_to 함수의 system call 함수
+int
+sys_yield_to(void)
+{
+  int pid;
+
+  if(argint(0, &pid) < 0)
+    return -1;
+  return yield_to(pid);
+}
+
 // process가 속한 queue의 level을 반환하는 함수
 int
 getLevel(void)
@@ -508,14 +1161,18 @@ setPriority(int pid, int priority)
   struct proc *p;                                             // process를 찾는 for문을 돌리기 위해 필요한 process를 담는 변수
   int check = 0;                                              // priority가 설정되었는지 check하는 역할을 하는 변수
 
-  if(priority < 0 || priority > 3)                            // priority의 값이 0~3 사이가 아닌 경우
+  if(priority < 0 || priority > mlfq.nprio - 1)               // priority의 값이 0~(nprio-1) 사이가 아닌 경우
     cprintf("setPriority error\n");                           // error 문구 출력
-  else{                                                       // priority의 값이 0~3 사이인 경우
+  else{                                                       // priority의 값이 0~(nprio-1) 사이인 경우
     // Loop over process table looking for process to run.
     acquire(&ptable.lock);                                    // ptable에 접근해 값을 수정해야 하기 때문에 lock을 얻음
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){       // ptable의 process 처음부터 끝까지 탐색
       if(p->pid == pid){                                      // 해당 pid를 가진 process를 찾으면
+        if(p->state == RUNNABLE)                              // run queue에 들어있는 process라면
+          dequeue(p);                                         // 기존 priority의 queue에서 뺌
         p->priority = priority;                               // 해당 process에 priority 값을 넣음
+        if(p->state == RUNNABLE)
+          enqueue(p);                                         // 새 priority의 queue에 넣음
         check = 1;                                            // priority가 설정되었으므로 check를 1로
         break;                                                // riority가 설정되었으면 반복문 탈출
       }
@@ -558,6 +1215,7 @@ schedulerLock(int password)
     release(&ptable.lock);                                                         // ptable lock 해제
     if (check == 0){                                                               // scheduler lock이 걸린 proecss가 없다면 (check가 0이라면)
       myproc()->qualification = 1;                                                 // 우선으로 처리되어야 할 자격을 얻음
+      trace(TR_LOCK, myproc());
       global_ticks = 0;                                                            // global tick은 priority boosting 없이 0으로 초기화
     }
   }
@@ -587,9 +1245,10 @@ schedulerUnlock(int password)
   if(password == 2019042497 && myproc()->qualification == 1){ // 암호가 일치하고, 자격이 있을 시
     myproc()->qualification = 0;                              // 우선으로 처리되어야 할 자격을 해제
     myproc()->q_level = 0;                                    // L0 queue로 이동
-    myproc()->priority = 3;                                   // priority를 3으로 설정
+    myproc()->priority = mlfq.nprio - 1;                      // 가장 낮은 priority로 설정
     myproc()->t_quantum = 0;                                  // time quantum 초기화
     myproc()->order = 0;                                      // L0 queue의 가장 앞 순서로 지정
+    trace(TR_UNLOCK, myproc());
   }
   else{                                                       // 암호가 일치하지 않거나 자격이 없을 시
     cprintf("pid: %d, time quantum: %d, current queue level: %d\n",
@@ -611,6 +1270,435 @@ sys_schedulerUnlock(void)
   return 0;                     // 0을 return
 }
 
+// 해당 pid의 process를 tickets개의 ticket을 가진 stride class로 옮기는 함수
+// tickets가 0이면 MLFQ class로 되돌림
+int
+settickets(int pid, int tickets)
+{
+  struct proc *p;
+
+  if(tickets < 0 || tickets > MAXTICKETS)                     // ticket 수가 범위를 벗어나면
+    return -1;
+  acquire(&ptable.lock);
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){         // ptable의 process 처음부터 끝까지 탐색
+    if(p->pid != pid || p->state == UNUSED)
+      continue;
+    if(p->rt_period){                                         // real-time class process는 stride class로 옮길 수 없음
+      release(&ptable.lock);
+      return -1;
+    }
+    if(p->state == RUNNABLE)                                  // run queue에 들어있는 process라면
+      dequeue(p);                                             // 기존 class의 queue에서 뺌
+    p->tickets = tickets;
+    p->stride = tickets ? STRIDE1 / tickets : 0;
+    p->t_quantum = 0;                                         // MLFQ로 돌아올 때 time quantum을 새로 셈
+    if(p->state == RUNNABLE)
+      enqueue(p);                                             // 새 class의 queue에 넣음
+    release(&ptable.lock);
+    return 0;
+  }
+  release(&ptable.lock);
+  return -1;                                                  // 해당 pid가 없는 경우
+}
+
+// settickets 함수의 system call 함수
+int
+sys_settickets(void)
+{
+  int pid, tickets;
+
+  if(argint(0, &pid) < 0 || argint(1, &tickets) < 0)
+    return -1;
+  return settickets(pid, tickets);
+}
+
+// stride class가 가져갈 CPU 비율(%)을 정하는 함수
+int
+setstrideshare(int share)
+{
+  if(share < 1 || share > 99)                                 // 두 class 모두 CPU를 조금이라도 가져가야 함
+    return -1;
+  acquire(&ptable.lock);
+  stride_share = share;
+  release(&ptable.lock);
+  return 0;
+}
+
+// setstrideshare 함수의 system call 함수
+int
+sys_setstrideshare(void)
+{
+  int share;
+
+  if(argint(0, &share) < 0)
+    return -1;
+  return setstrideshare(share);
+}
+
+// 해당 pid의 process가 실행될 수 있는 cpu를 mask로 정하는 함수 (pid가 0이면 자기 자신)
+// run queue에서 기다리던 process는 바로 실행될 수 있는 cpu로 옮기고,
+// 다른 cpu에서 실행 중인 process는 다음에 yield 할 때 옮겨짐
+int
+sched_setaffinity(int pid, uint mask)
+{
+  struct proc *p;
+
+  mask &= (1 << ncpu) - 1;                                    // 존재하는 cpu만 남김
+  if(mask == 0)                                               // 실행될 수 있는 cpu가 없다면
+    return -1;
+  if(pid == 0)
+    pid = myproc()->pid;
+  acquire(&ptable.lock);
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){         // ptable의 process 처음부터 끝까지 탐색
+    if(p->pid != pid || p->state == UNUSED)
+      continue;
+    if(p->rt_period && !((mask >> (p->rt_cpu - cpus)) & 1)){  // real-time process는 admission 된 cpu를 빼면 안 됨
+      release(&ptable.lock);
+      return -1;
+    }
+    p->cpumask = mask;
+    if(p->state == RUNNABLE && !allowed(p, p->rq_cpu)){       // 실행될 수 없는 cpu에서 기다리고 있다면
+      dequeue(p);
+      p->rq_cpu = pick_cpu(p);
+      enqueue(p);
+      kick(p->rq_cpu);
+    }
+    release(&ptable.lock);
+    return 0;
+  }
+  release(&ptable.lock);
+  return -1;                                                  // 해당 pid가 없는 경우
+}
+
+// sched_setaffinity 함수의 system call 함수
+int
+sys_sched_setaffinity(void)
+{
+  int pid, mask;
+
+  if(argint(0, &pid) < 0 || argint(1, &mask) < 0)
+    return -1;
+  return sched_setaffinity(pid, (uint)mask);
+}
+
+// 해당 pid의 process의 affinity mask를 반환하는 함수 (pid가 0이면 자기 자신)
+int
+sched_getaffinity(int pid)
+{
+  struct proc *p;
+  int mask;
+
+  if(pid == 0)
+    pid = myproc()->pid;
+  acquire(&ptable.lock);
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->pid == pid && p->state != UNUSED){
+      mask = p->cpumask & ((1 << ncpu) - 1);
+      release(&ptable.lock);
+      return mask;
+    }
+  }
+  release(&ptable.lock);
+  return -1;
+}
+
+// sched_getaffinity 함수의 system call 함수
+int
+sys_sched_getaffinity(void)
+{
+  int pid;
+
+  if(argint(0, &pid) < 0)
+    return -1;
+  return sched_getaffinity(pid);
+}
+
+// scheduler 통계를 st에 채우는 함수
+void
+getschedstat(struct schedstat *st)
+{
+  struct proc *p;
+  struct procstat *ps;
+
+  acquire(&ptable.lock);
+  st->ticks = ticks;
+  memmove(st->hist, sstat.hist, sizeof(st->hist));
+  memmove(st->ndispatch, sstat.ndispatch, sizeof(st->ndispatch));
+  st->ndemote = sstat.ndemote;
+  st->nboost = sstat.nboost;
+  st->nproc = 0;
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){    // 사용 중인 process만 담음
+    if(p->state == UNUSED)
+      continue;
+    ps = &st->proc[st->nproc++];
+    ps->pid = p->pid;
+    ps->state = p->state;
+    ps->q_level = p->q_level;
+    ps->priority = p->priority;
+    memmove(ps->run_ticks, p->run_ticks, sizeof(ps->run_ticks));
+    memmove(ps->wait_ticks, p->wait_ticks, sizeof(ps->wait_ticks));
+    ps->ndispatch = p->ndispatch;
+    ps->ndemote = p->ndemote;
+    ps->nboost = p->nboost;
+    safestrcpy(ps->name, p->name, sizeof(ps->name));
+  }
+  release(&ptable.lock);
+}
+
+// getschedstat 함수의 system call 함수
+int
+sys_getschedstat(void)
+{
+  struct schedstat *st;
+
+  if(argptr(0, (void*)&st, sizeof(*st)) < 0)  // 인자가 올바른 user 주소가 아니라면
+    return -1;                                // -1 return해 오류임을 표시
+  getschedstat(st);
+  return 0;
+}
+
+// 현재 process의 CPU 사용량을 ru에 채우는 함수
+// who가 RUSAGE_SELF이면 자신의, RUSAGE_CHILDREN이면 wait()로 회수한 자식들의 사용량
+int
+getrusage(int who, struct rusage *ru)
+{
+  struct proc *curproc = myproc();
+
+  if(who != RUSAGE_SELF && who != RUSAGE_CHILDREN)
+    return -1;
+  acquire(&ptable.lock);
+  *ru = who == RUSAGE_SELF ? curproc->ru : curproc->cru;
+  release(&ptable.lock);
+  return 0;
+}
+
+// getrusage 함수의 system call 함수
+int
+sys_getrusage(void)
+{
+  int who;
+  struct rusage *ru;
+
+  if(argint(0, &who) < 0 || argptr(1, (void*)&ru, sizeof(*ru)) < 0)
+    return -1;
+  return getrusage(who, ru);
+}
+
+// 현재 process가 sleeplock lk를 기다리기 전에 호출하는 함수
+// lk를 가진 process의 run queue 번호가 현재 process보다 뒤라면 현재 process의 것을 빌려줌
+// lk를 가진 process가 또 다른 sleeplock을 기다리고 있다면 그 lock을 가진 process에게도 이어서 빌려줌
+// lk->lk를 잡은 상태에서 호출해야 함
+void
+inherit_priority(struct sleeplock *lk)
+{
+  struct proc *p = myproc();
+  struct proc *h;
+  int rank, depth;
+
+  acquire(&ptable.lock);
+  p->pi_wait = lk;
+  if(rt_class(p) || p->qualification)                    // real-time class나 schedulerLock이 걸린 process라면
+    rank = 1;                                            // L0의 맨 앞 queue를 빌려줌
+  else
+    rank = effective_rank(p);
+  h = lk->holder;
+  for(depth = 0; h && h != p && depth < NPROC; depth++){
+    if(effective_rank(h) > rank){
+      if(h->state == RUNNABLE)                           // run queue 번호가 바뀌므로 뺐다가 다시 넣음
+        dequeue(h);
+      h->pi_rank = rank;
+      if(h->state == RUNNABLE)
+        enqueue(h);
+    }
+    h = h->pi_wait ? h->pi_wait->holder : 0;
+  }
+  release(&ptable.lock);
+}
+
+// 현재 process가 sleeplock을 놓을 때 호출하는 함수
+// 가진 sleeplock이 더 이상 없으면 빌려받은 run queue 번호를 돌려줌
+// (여러 개를 가지고 있는 동안은 어느 lock을 기다리는 process에게 빌린 것인지 모르므로 그대로 둠)
+void
+restore_priority(void)
+{
+  struct proc *p = myproc();
+
+  acquire(&ptable.lock);
+  if(p->nsleeplock > 0 && --p->nsleeplock == 0)
+    p->pi_rank = 0;                                      // 실행 중이므로 queue에 없어 바로 바꿀 수 있음
+  release(&ptable.lock);
+}
+
+// real-time process의 replenish timer (ptable.proc과 같은 index), tickslock으로 보호
+static struct timer rt_timer[NPROC];
+
+// real-time process가 주기마다 쓸 수 있는 이용률 (1/1000 단위, 올림)
+static int
+rt_util(int period, int runtime)
+{
+  return (runtime * 1000 + period - 1) / period;
+}
+
+// real-time process의 주기가 끝날 때 timer에서 호출되는 함수
+// deadline을 다음 주기로 넘기고 budget을 다시 채우며, budget을 다 써서 멈춰 있었다면 real-time class로 되돌림
+// tickslock을 잡은 상태에서 호출됨
+static void
+rt_replenish(void *arg)
+{
+  struct proc *p = arg;
+
+  acquire(&ptable.lock);
+  if(p->state == RUNNABLE)                               // deadline이나 class가 바뀌므로 queue에서 뺐다가 다시 넣음
+    dequeue(p);
+  p->rt_deadline += p->rt_period;
+  p->rt_budget = p->rt_runtime;
+  p->rt_throttled = 0;
+  if(p->state == RUNNABLE){
+    p->rq_cpu = p->rt_cpu;
+    enqueue(p);
+    kick(p->rq_cpu);
+  }
+  timer_add(&rt_timer[p - ptable.proc], p->rt_deadline, rt_replenish, p);
+  release(&ptable.lock);
+}
+
+// 현재 실행 중인 real-time process의 budget을 1 tick 쓰는 함수
+// budget을 다 쓰면 다음 주기까지 MLFQ class로 실행됨
+// timer interrupt에서 호출됨
+void
+rt_charge(struct proc *p)
+{
+  acquire(&ptable.lock);
+  if(p->rt_budget > 0 && --p->rt_budget == 0)
+    p->rt_throttled = 1;                                 // 실행 중이므로 queue에 없어 바로 바꿀 수 있음
+  release(&ptable.lock);
+}
+
+// 현재 process를 주기 period tick마다 runtime tick을 보장받는 real-time class로 등록하는 함수
+// 이용률의 합이 RTUTIL_MAX를 넘지 않는 cpu가 있어야 admission 되고, 그 cpu에서 EDF로 실행됨
+// period가 0이면 real-time class에서 빠짐
+int
+sched_setrt(int period, int runtime)
+{
+  struct proc *p = myproc();
+  struct timer *t = &rt_timer[p - ptable.proc];
+  struct cpu *c, *best = 0;
+  int util = 0;
+
+  if(period < 0 || (period > 0 && (runtime < 1 || runtime > period)))
+    return -1;
+  if(period)
+    util = rt_util(period, runtime);
+  acquire(&tickslock);                                   // timer_expire()와 같은 순서로 lock을 잡음
+  acquire(&ptable.lock);
+  if(p->tickets){                                        // stride class process는 real-time class가 될 수 없음
+    release(&ptable.lock);
+    release(&tickslock);
+    return -1;
+  }
+  if(p->rt_period)                                       // 이전 등록의 이용률은 빼고 admission을 검사함
+    p->rt_cpu->rt_util -= rt_util(p->rt_period, p->rt_runtime);
+  if(period){
+    for(c = cpus; c < &cpus[ncpu]; c++)                  // 들어갈 수 있는 cpu 중 가장 여유 있는 cpu
+      if(((p->cpumask >> (c - cpus)) & 1) && c->rt_util + util <= RTUTIL_MAX &&
+         (!best || c->rt_util < best->rt_util))
+        best = c;
+    if(best == 0){                                       // admission 실패, 이전 등록은 그대로 둠
+      if(p->rt_period)
+        p->rt_cpu->rt_util += rt_util(p->rt_period, p->rt_runtime);
+      release(&ptable.lock);
+      release(&tickslock);
+      return -1;
+    }
+  }
+  timer_del(t);
+  p->rt_period = period;                                 // 실행 중이므로 queue에 없어 바로 바꿀 수 있음
+  p->rt_runtime = runtime;
+  p->rt_budget = runtime;
+  p->rt_throttled = 0;
+  p->rt_cpu = best;
+  if(period){
+    best->rt_util += util;
+    p->rt_deadline = ticks + period;
+    timer_add(t, p->rt_deadline, rt_replenish, p);
+  }
+  release(&ptable.lock);
+  release(&tickslock);
+  return 0;
+}
+
+// sched_setrt 함수의 system call 함수
+// admission 된 cpu로 옮겨 바로 EDF로 실행되도록 양보함
+int
+sys_sched_setrt(void)
+{
+  int period, runtime;
+
+  if(argint(0, &period) < 0 || argint(1, &runtime) < 0)
+    return -1;
+  if(sched_setrt(period, runtime) < 0)
+    return -1;
+  yield();
+  return 0;
+}
+
+// MLFQ policy를 old에 담고, new가 0이 아니면 new로 바꾸는 함수
+// run queue를 비우지 않고, 들어있던 process들을 새 policy의 level과 priority 범위에 맞춰 다시 넣음
+int
+mlfqpolicy(struct mlfqpolicy *new, struct mlfqpolicy *old)
+{
+  struct mlfqpolicy pol;
+  struct cpu *c;
+  struct proc *p;
+  int i;
+
+  if(new){
+    pol = *new;                                          // 검사하는 도중에 바뀌지 않도록 복사해 둠
+    if(pol.nlevel < 1 || pol.nlevel > MAXLEVEL)
+      return -1;
+    for(i = 0; i < pol.nlevel; i++)
+      if(pol.quantum[i] < 1)
+        return -1;
+    if(pol.nprio < 1 || pol.nprio > MAXPRIO || pol.boost < 0 || pol.aging < 0)
+      return -1;
+  }
+  acquire(&ptable.lock);
+  if(old)
+    *old = mlfq;
+  if(new){
+    mlfq = pol;
+    for(c = cpus; c < &cpus[ncpu]; c++)                  // run queue 번호가 바뀌므로 list를 새로 만듦
+      for(i = 0; i < NRUNQ; i++)
+        c->rq_head[i] = c->rq_tail[i] = 0;
+    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+      if(p->state == UNUSED)
+        continue;
+      mlfq_clamp(p);                                     // 없어진 level, priority에 있던 process는 마지막으로
+      if(p->state == RUNNABLE && p->heap_idx < 0 && !rt_class(p)) // MLFQ run queue에 있던 process는 다시 넣음
+        runq_insert(p);
+    }
+  }
+  release(&ptable.lock);
+  return 0;
+}
+
+// mlfqpolicy 함수의 system call 함수
+// 두 인자 모두 0을 넘기면 해당 동작을 하지 않음
+int
+sys_mlfqpolicy(void)
+{
+  struct mlfqpolicy *new = 0, *old = 0;
+  int n, o;
+
+  if(argint(0, &n) < 0 || argint(1, &o) < 0)
+    return -1;
+  if(n && argptr(0, (void*)&new, sizeof(*new)) < 0)
+    return -1;
+  if(o && argptr(1, (void*)&old, sizeof(*old)) < 0)
+    return -1;
+  return mlfqpolicy(new, old);
+}
+
 // A fork child's very first scheduling by scheduler()
 // will swtch here.  "Return" to user space.
 void
@@ -658,6 +1746,7 @@ sleep(void *chan, struct spinlock *lk)
   // Go to sleep.
   p->chan = chan;
   p->state = SLEEPING;
+  waitq_insert(p);
 
   sched();
 
@@ -677,11 +1766,16 @@ sleep(void *chan, struct spinlock *lk)
 static void
 wakeup1(void *chan)
 {
-  struct proc *p;
-
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if(p->state == SLEEPING && p->chan == chan)
-      p->state = RUNNABLE;
+  struct proc *p, *next;
+
+  for(p = *waitq(chan); p; p = next){     // chan의 wait queue에 있는 process만 확인
+    next = p->wq_next;
+    if(p->chan == chan){                  // hash가 겹친 다른 chan의 process는 그대로 둠
+      waitq_remove(p);
+      make_runnable(p);
+      trace(TR_WAKEUP, p);
+    }
+  }
 }
 
 // Wake up all processes sleeping on chan.
@@ -706,8 +1800,10 @@ kill(int pid)
     if(p->pid == pid){
       p->killed = 1;
       // Wake process from sleep if necessary.
-      if(p->state == SLEEPING)
-        p->state = RUNNABLE;
+      if(p->state == SLEEPING){
+        waitq_remove(p);
+        make_runnable(p);
+      }
       release(&ptable.lock);
       return 0;
     }
@@ -1,3 +1,13 @@
+// run queue 개수 (schedulerLock, 마지막을 뺀 level마다 하나, 마지막 level의 priority마다 하나)
+#define NRUNQ (MAXLEVEL + MAXPRIO)
+
+// stride scheduling
+#define STRIDE1    (1<<16)     // ticket 1개일 때의 stride
+#define MAXTICKETS 1000        // process 하나가 가질 수 있는 최대 ticket 수
+
+// real-time (EDF) class
+#define RTUTIL_MAX 800         // cpu 하나에서 real-time class에 admission 할 수 있는 최대 이용률 (1/1000 단위)
+
 // Per-CPU state
 struct cpu {
   uchar apicid;                // Local APIC ID
@@ -7,7 +17,20 @@ struct cpu {
   volatile uint started;       // Has the CPU started?
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
-  struct proc *proc;           // The process running on this cpu or null
+  struct cpu *self;            // 이 cpu 자신, %gs:0 (proc 바로 앞에 있어야 함)
+  struct proc *proc;           // The process running on this cpu or null, %gs:4
+  struct proc *handoff;        // yield_to()로 다음에 바로 실행하도록 지정된 process
+  volatile int idle;           // 할 일이 없어 hlt로 멈춰 있는지
+  struct proc *rq_head[NRUNQ]; // 이 cpu의 각 run queue 맨 앞 process
+  struct proc *rq_tail[NRUNQ]; // 이 cpu의 각 run queue 맨 뒤 process
+  int nrunnable;               // 이 cpu의 run queue에 있는 process 수
+  struct proc *stride_heap[NPROC]; // stride class process의 pass 기준 min-heap
+  int nstride;                 // stride_heap에 있는 process 수
+  uint mlfq_pass;              // MLFQ class의 pass
+  uint stride_pass;            // stride class의 pass
+  uint stride_vtime;           // 마지막으로 dispatch 된 stride process의 pass
+  struct proc *rt_head;        // real-time class process들의 deadline 순 queue
+  int rt_util;                 // admission 된 real-time process들의 이용률 합 (1/1000 단위)
 };
 
 extern struct cpu cpus[NCPU];
@@ -45,6 +68,8 @@ struct proc {
   struct trapframe *tf;        // Trap frame for current syscall
   struct context *context;     // swtch() here to run process
   void *chan;                  // If non-zero, sleeping on chan
+  struct proc *wq_next;        // 같은 wait queue에서 다음 process
+  struct proc *wq_prev;        // 같은 wait queue에서 이전 process
   int killed;                  // If non-zero, have been killed
   struct file *ofile[NOFILE];  // Open files
   struct inode *cwd;           // Current directory
@@ -53,8 +78,33 @@ struct proc {
   int t_quantum;               // time quantum
   int priority;                // priority
   uint order;                  // L0, L1, L2 안에 들어온 order
-  uint boosting_tmp;           // priority boosting할 때 임시로 담는 순서
   int qualification;           // 우선 처리되어야 할 qualification
+  struct proc *rq_next;        // run queue에서 다음 process
+  struct proc *rq_prev;        // run queue에서 이전 process
+  struct cpu *rq_cpu;          // 들어가 있는 (또는 마지막으로 실행된) run queue의 cpu
+  uint enq_tick;               // run queue에 들어간 tick
+  uint run_ticks[MAXLEVEL];    // level별 실행 시간
+  uint wait_ticks[MAXLEVEL];   // level별 run queue 대기 시간
+  uint ndispatch;              // dispatch 된 횟수
+  uint ndemote;                // 아래 level로 내려간 횟수
+  uint nboost;                 // priority boosting 된 횟수
+  int tickets;                 // stride class의 ticket 수 (0이면 MLFQ class)
+  uint stride;                 // STRIDE1 / tickets
+  uint pass;                   // stride class에서의 pass
+  int heap_idx;                // stride_heap 안의 위치 (들어있지 않으면 -1)
+  uint cpumask;                // 실행될 수 있는 cpu의 bitmask (i번째 bit가 cpus[i])
+  uint rt_period;              // real-time class의 주기 (tick, 0이면 real-time class가 아님)
+  uint rt_runtime;             // 주기마다 쓸 수 있는 실행 시간 (tick)
+  uint rt_budget;              // 이번 주기에 남은 실행 시간
+  uint rt_deadline;            // 이번 주기가 끝나는 tick (EDF의 deadline)
+  int rt_throttled;            // budget을 다 써서 다음 주기까지 MLFQ class로 실행되면 1
+  struct cpu *rt_cpu;          // admission 된 cpu (real-time class는 이 cpu에서만 실행)
+  int pi_rank;                 // sleeplock을 기다리는 process에게 빌려받은 run queue 번호 (0이면 없음)
+  struct sleeplock *pi_wait;   // 기다리고 있는 sleeplock
+  int nsleeplock;              // 가지고 있는 sleeplock 수
+  struct rusage ru;            // CPU 사용량
+  int preempted;               // timer interrupt로 yield 하는 중이면 1 (sched()에서 확인하고 지움)
+  struct rusage cru;           // wait()로 회수한 자식들의 CPU 사용량 합
 };
 
 // Process memory is laid out contiguously, low addresses first:
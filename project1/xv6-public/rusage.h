@@ -0,0 +1,13 @@
+// getrusage()로 받아오는 process의 CPU 사용량
+// 시간 단위는 timer tick
+
+#define RUSAGE_SELF      0       // 자기 자신의 사용량
+#define RUSAGE_CHILDREN (-1)     // wait()로 회수한 자식들의 사용량 합
+
+struct rusage {
+  uint utime;                    // user mode에서 실행한 시간
+  uint stime;                    // kernel mode에서 실행한 시간
+  uint nvcsw;                    // 자발적인 context switch 횟수 (sleep, yield)
+  uint nivcsw;                   // 비자발적인 context switch 횟수 (timer에 의한 선점)
+  uint nfault;                   // user mode에서 난 page fault로 kill된 횟수 (demand paging이 없어 process마다 0 또는 1)
+};
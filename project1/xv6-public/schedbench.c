@@ -0,0 +1,369 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+#include "trace.h"
+
+// 사용법: schedbench [-t ticks] [ncpu nio npipe nyield]
+// 종류별 worker를 섞어 ticks 동안 동시에 실행하고, 결과를 한 줄로 출력
+// worker 수를 주지 않으면 process 수와 종류 조합을 바꿔가며 차례로 실행
+//
+// cpu   : 계산만 반복
+// io    : sleep(1) 후 조금 계산하는 것을 반복
+// pipe  : 두 개씩 짝을 지어 pipe로 1 byte를 주고받는 것을 반복 (짝수로 올림)
+// yield : 조금 계산하고 yield()하는 것을 반복
+//
+// 출력 형식 (key=value를 공백으로 구분, 시간 단위는 tick)
+//   bench procs=N ticks=T cpu=.. io=.. pipe=.. yield=.. work=W work_per_tick=W/T
+//         [kind_work=.. kind_jain=..]... lat_n=.. lat_p50=.. lat_p99=.. lat_max=..
+// jain은 같은 종류 worker들이 한 일의 Jain's fairness index에 1000을 곱한 값
+// lat은 wakeup()으로 RUNNABLE이 된 뒤 dispatch될 때까지 걸린 시간 (gettrace로 측정)
+// trace에는 tick만 기록되므로 lat은 정수 tick 단위이며, 0은 wakeup과 같은 tick 안에 dispatch 되었다는 뜻
+// lat_p50, lat_p99는 NLAT-1 tick에서 잘리지만 lat_max는 잘리지 않은 실제 최댓값
+
+#define NWORKER 48               // 한 번에 띄우는 최대 worker 수
+#define NEV (NCPU * NTRACE)
+#define NLAT 64                  // latency histogram 크기 (마지막 칸은 그 이상)
+
+#define CPU_UNIT   2000          // cpu worker의 일 한 단위 (반복 횟수)
+#define SMALL_UNIT 200           // io, yield worker가 한 번에 하는 계산
+
+enum { W_CPU, W_IO, W_PIPE, W_YIELD, NKIND };
+
+static char *kinds[] = {
+[W_CPU]   "cpu",
+[W_IO]    "io",
+[W_PIPE]  "pipe",
+[W_YIELD] "yield",
+};
+
+struct result {
+  int slot;                      // worker 번호
+  int work;                      // 끝낸 일의 단위 수
+};
+
+int wpid[NWORKER];               // worker의 pid
+int wkind[NWORKER];              // worker의 종류
+int work[NWORKER];               // worker가 끝낸 일
+int pending[NWORKER];            // 마지막 wakeup이 기록된 tick (없으면 -1)
+int nworker;
+
+uint lat[NLAT];                  // wakeup부터 dispatch까지 걸린 tick의 histogram
+uint nlat;
+uint lat_max;                    // histogram에서 잘리지 않은 최대 latency
+
+struct traceev ev[NEV];
+volatile int sink;               // 계산이 최적화로 사라지지 않게 함
+
+void
+usage(void)
+{
+  printf(2, "usage: schedbench [-t ticks] [ncpu nio npipe nyield]\n");
+  exit();
+}
+
+void
+spin(int n)
+{
+  int i;
+
+  for(i = 0; i < n; i++)
+    sink += i;
+}
+
+// slot번 worker의 본체, deadline tick까지 일하고 결과를 res로 보냄
+// pipe worker는 in/out으로 짝과 1 byte씩 주고받으며, lead인 쪽이 먼저 보냄
+void
+worker(int slot, int deadline, int res, int in, int out, int lead)
+{
+  struct result r;
+  char c = 0;
+
+  r.slot = slot;
+  r.work = 0;
+  switch(wkind[slot]){
+  case W_CPU:
+    while(uptime() < deadline){
+      spin(CPU_UNIT);
+      r.work++;
+    }
+    break;
+  case W_IO:
+    while(uptime() < deadline){
+      sleep(1);
+      spin(SMALL_UNIT);
+      r.work++;
+    }
+    break;
+  case W_PIPE:
+    if(lead){                      // 먼저 보내고 답을 기다림
+      while(uptime() < deadline){
+        if(write(out, &c, 1) != 1 || read(in, &c, 1) != 1)
+          break;
+        r.work++;
+      }
+    } else {                       // 받은 것을 돌려보냄, 짝이 끝내면 read가 0을 반환
+      while(read(in, &c, 1) == 1){
+        if(write(out, &c, 1) != 1)
+          break;
+        r.work++;
+      }
+    }
+    close(in);
+    close(out);
+    break;
+  case W_YIELD:
+    while(uptime() < deadline){
+      spin(SMALL_UNIT);
+      yield();
+      r.work++;
+    }
+    break;
+  }
+  write(res, &r, sizeof(r));
+  exit();
+}
+
+// worker pid의 번호를 반환하는 함수 (worker가 아니면 -1)
+int
+slotof(int pid)
+{
+  int i;
+
+  for(i = 0; i < nworker; i++)
+    if(wpid[i] == pid)
+      return i;
+  return -1;
+}
+
+// tracedump와 같이 cpu별로 나뉘어 온 trace를 seq 순으로 정렬하는 함수
+void
+sort(int n)
+{
+  struct traceev t;
+  int i, j;
+
+  for(i = 1; i < n; i++){
+    t = ev[i];
+    for(j = i; j > 0 && (int)(ev[j-1].seq - t.seq) > 0; j--)
+      ev[j] = ev[j-1];
+    ev[j] = t;
+  }
+}
+
+// 쌓인 trace를 읽어 worker가 wakeup된 뒤 dispatch될 때까지 걸린 시간을 histogram에 더함
+void
+drain(void)
+{
+  int i, n, s, d;
+
+  while((n = gettrace(ev, NEV)) > 0){
+    sort(n);
+    for(i = 0; i < n; i++){
+      if((s = slotof(ev[i].pid)) < 0)
+        continue;
+      if(ev[i].type == TR_WAKEUP && pending[s] < 0)
+        pending[s] = ev[i].tick;
+      else if(ev[i].type == TR_RUN && pending[s] >= 0){
+        d = ev[i].tick - pending[s];
+        lat[d < NLAT ? d : NLAT-1]++;
+        nlat++;
+        if(d > lat_max)
+          lat_max = d;
+        pending[s] = -1;
+      }
+    }
+  }
+}
+
+// histogram에서 전체의 pct %가 들어가는 latency를 반환하는 함수
+int
+percentile(int pct)
+{
+  uint sum = 0, want;
+  int i;
+
+  if(nlat == 0)
+    return 0;
+  want = (nlat * pct + 99) / 100;
+  for(i = 0; i < NLAT; i++){
+    sum += lat[i];
+    if(sum >= want)
+      return i;
+  }
+  return NLAT-1;
+}
+
+// kind 종류 worker들의 Jain's fairness index * 1000을 반환하는 함수
+// (sum x)^2 / (n * sum x^2) 를 overflow 없이 계산하도록 가장 많이 한 worker를 1000으로 맞춤
+int
+jain(int kind)
+{
+  uint max = 0, scale, x, n = 0, sum = 0, sq = 0;
+  int i;
+
+  for(i = 0; i < nworker; i++)
+    if(wkind[i] == kind && work[i] > max)
+      max = work[i];
+  if(max == 0)
+    return 1000;
+  scale = (max + 999) / 1000;
+  for(i = 0; i < nworker; i++){
+    if(wkind[i] != kind)
+      continue;
+    x = work[i] / scale;
+    n++;
+    sum += x;
+    sq += x * x;
+  }
+  sq /= 1000;
+  if(sq == 0)
+    return 1000;
+  return sum * sum / (n * sq);
+}
+
+// 종류별 worker 수가 cnt인 조합을 ticks 동안 실행하고 결과를 출력하는 함수
+// pipe worker의 pipe는 짝을 fork하기 직전에 만들고 바로 닫아서 다른 worker에게 물려주지 않음
+void
+run(int *cnt, int ticks)
+{
+  int i, k, go[2], res[2], pp[2][2], lead, pid, deadline, total;
+  struct result r;
+
+  nworker = 0;
+  for(k = 0; k < NKIND; k++)
+    for(i = 0; i < cnt[k]; i++)
+      wkind[nworker++] = k;
+  memset(work, 0, sizeof(work));
+  memset(lat, 0, sizeof(lat));
+  nlat = 0;
+  lat_max = 0;
+
+  if(pipe(go) < 0 || pipe(res) < 0){
+    printf(2, "schedbench: pipe failed\n");
+    exit();
+  }
+
+  while(gettrace(ev, NEV) > 0)     // 이전 trace는 버림
+    ;
+  lead = 1;
+  for(i = 0; i < nworker; i++){
+    pending[i] = -1;
+    if(wkind[i] == W_PIPE && lead && (pipe(pp[0]) < 0 || pipe(pp[1]) < 0)){
+      printf(2, "schedbench: pipe failed\n");
+      exit();
+    }
+    pid = fork();
+    if(pid < 0){
+      printf(2, "schedbench: fork failed\n");
+      exit();
+    }
+    if(pid == 0){
+      close(go[1]);
+      close(res[0]);
+      if(read(go[0], &deadline, sizeof(deadline)) != sizeof(deadline))
+        exit();
+      close(go[0]);
+      if(wkind[i] == W_PIPE){      // lead는 pp[1]로 보내고 pp[0]으로 받음, 짝은 반대
+        close(pp[lead][0]);
+        close(pp[1-lead][1]);
+        worker(i, deadline, res[1], pp[1-lead][0], pp[lead][1], lead);
+      }
+      worker(i, deadline, res[1], -1, -1, 0);
+    }
+    wpid[i] = pid;
+    if(wkind[i] == W_PIPE){
+      if(!lead){                   // 짝까지 fork했으면 부모는 더 쓰지 않음
+        close(pp[0][0]);
+        close(pp[0][1]);
+        close(pp[1][0]);
+        close(pp[1][1]);
+      }
+      lead = !lead;
+    }
+  }
+  close(go[0]);
+  close(res[1]);
+
+  deadline = uptime() + ticks;       // 모든 worker를 한꺼번에 출발시킴
+  for(i = 0; i < nworker; i++)
+    write(go[1], &deadline, sizeof(deadline));
+  close(go[1]);
+
+  while(uptime() < deadline){        // ring이 넘치지 않도록 실행 중에도 trace를 읽어감
+    drain();
+    sleep(1);
+  }
+  while(read(res[0], &r, sizeof(r)) == sizeof(r))
+    if(r.slot >= 0 && r.slot < nworker)
+      work[r.slot] = r.work;
+  close(res[0]);
+  while(wait() != -1)
+    ;
+  drain();
+
+  total = 0;
+  for(i = 0; i < nworker; i++)
+    total += work[i];
+  printf(1, "bench procs=%d ticks=%d cpu=%d io=%d pipe=%d yield=%d work=%d work_per_tick=%d",
+         nworker, ticks, cnt[W_CPU], cnt[W_IO], cnt[W_PIPE], cnt[W_YIELD], total, total / ticks);
+  for(k = 0; k < NKIND; k++){
+    if(cnt[k] == 0)
+      continue;
+    total = 0;
+    for(i = 0; i < nworker; i++)
+      if(wkind[i] == k)
+        total += work[i];
+    printf(1, " %s_work=%d %s_jain=%d", kinds[k], total, kinds[k], jain(k));
+  }
+  printf(1, " lat_n=%d lat_p50=%d lat_p99=%d lat_max=%d\n",
+         nlat, percentile(50), percentile(99), lat_max);
+}
+
+int
+main(int argc, char *argv[])
+{
+  static int nprocs[] = { 2, 4, 8, 16 };
+  int ticks = 100, cnt[NKIND], i, k, n, argi = 1;
+
+  if(argi + 1 < argc && strcmp(argv[argi], "-t") == 0){
+    if((ticks = atoi(argv[argi+1])) <= 0)
+      usage();
+    argi += 2;
+  }
+
+  if(argi < argc){                   // 주어진 조합 하나만 실행
+    if(argc - argi != NKIND)
+      usage();
+    n = 0;
+    for(k = 0; k < NKIND; k++){
+      cnt[k] = atoi(argv[argi+k]);
+      n += cnt[k];
+    }
+    n += cnt[W_PIPE] % 2;
+    cnt[W_PIPE] += cnt[W_PIPE] % 2;
+    if(n > NWORKER){
+      printf(2, "schedbench: at most %d workers\n", NWORKER);
+      exit();
+    }
+    run(cnt, ticks);
+    exit();
+  }
+
+  // 각 process 수마다 한 종류만 띄운 경우와 네 종류를 고르게 섞은 경우를 실행
+  for(i = 0; i < sizeof(nprocs)/sizeof(nprocs[0]); i++){
+    n = nprocs[i];
+    for(k = 0; k <= NKIND; k++){
+      memset(cnt, 0, sizeof(cnt));
+      if(k < NKIND)
+        cnt[k] = n;
+      else
+        cnt[W_CPU] = cnt[W_IO] = cnt[W_PIPE] = cnt[W_YIELD] = n / 4;
+      if(n / 4 == 0 && k == NKIND)
+        continue;
+      cnt[W_PIPE] += cnt[W_PIPE] % 2;
+      run(cnt, ticks);
+    }
+  }
+  exit();
+}
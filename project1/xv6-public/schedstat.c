@@ -0,0 +1,79 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+#include "mlfq.h"
+#include "schedstat.h"
+
+// 사용법: schedstat [command args...]
+// command가 주어지면 실행이 끝날 때까지 기다린 뒤 scheduler 통계를 출력
+
+static char *states[] = { "unused", "embryo", "sleep ", "runble", "run   ", "zombie" };
+
+struct schedstat st;
+struct mlfqpolicy pol;
+
+void
+print_hist(void)
+{
+  int l, i;
+
+  printf(1, "wait before dispatch (ticks)\n");
+  printf(1, "level  dispatch     0     1   2-3   4-7  8-15 16-31 32-63   64+\n");
+  for(l = 0; l < pol.nlevel; l++){
+    printf(1, "L%d     %d", l, st.ndispatch[l]);
+    for(i = 0; i < NSCHEDHIST; i++)
+      printf(1, " %d", st.hist[l][i]);
+    printf(1, "\n");
+  }
+  printf(1, "demotions: %d, boosts: %d\n", st.ndemote, st.nboost);
+}
+
+void
+print_procs(void)
+{
+  int i, l;
+  struct procstat *ps;
+
+  printf(1, "pid state  name      level prio dispatch demote boost  run(per level)  wait(per level)\n");
+  for(i = 0; i < st.nproc; i++){
+    ps = &st.proc[i];
+    printf(1, "%d %s %s L%d %d %d %d %d  run", ps->pid, states[ps->state], ps->name,
+           ps->q_level, ps->priority, ps->ndispatch, ps->ndemote, ps->nboost);
+    for(l = 0; l < pol.nlevel; l++)
+      printf(1, " %d", ps->run_ticks[l]);
+    printf(1, "  wait");
+    for(l = 0; l < pol.nlevel; l++)
+      printf(1, " %d", ps->wait_ticks[l]);
+    printf(1, "\n");
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  int pid;
+
+  if(argc > 1){
+    pid = fork();
+    if(pid < 0){
+      printf(2, "schedstat: fork failed\n");
+      exit();
+    }
+    if(pid == 0){
+      exec(argv[1], argv + 1);
+      printf(2, "schedstat: exec %s failed\n", argv[1]);
+      exit();
+    }
+    wait();
+  }
+
+  if(getschedstat(&st) < 0 || mlfqpolicy(0, &pol) < 0){
+    printf(2, "schedstat: getschedstat failed\n");
+    exit();
+  }
+  printf(1, "ticks: %d\n", st.ticks);
+  print_hist();
+  print_procs();
+  exit();
+}
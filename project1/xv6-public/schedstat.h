@@ -0,0 +1,30 @@
+// getschedstat()으로 받아오는 scheduler 통계
+// 시간 단위는 모두 timer tick
+// mlfq.h를 먼저 include 해야 함
+
+#define NSCHEDHIST 8             // 대기 시간 histogram의 칸 수 (0, 1, 2~3, 4~7, ..., 64 이상)
+
+// process 하나의 통계
+struct procstat {
+  int pid;                       // Process ID
+  int state;                     // process 상태 (enum procstate)
+  int q_level;                   // 현재 queue level
+  int priority;                  // 현재 priority
+  uint run_ticks[MAXLEVEL];      // level별 실행 시간
+  uint wait_ticks[MAXLEVEL];     // level별 run queue 대기 시간
+  uint ndispatch;                // dispatch 된 횟수
+  uint ndemote;                  // 아래 level로 내려간 횟수
+  uint nboost;                   // priority boosting 된 횟수
+  char name[16];                 // Process name
+};
+
+// 전체 scheduler 통계
+struct schedstat {
+  uint ticks;                    // 통계를 가져온 시점의 ticks
+  uint hist[MAXLEVEL][NSCHEDHIST]; // level별 dispatch까지 걸린 대기 시간 histogram
+  uint ndispatch[MAXLEVEL];      // level별 dispatch 횟수
+  uint ndemote;                  // 전체 demotion 횟수
+  uint nboost;                   // priority boosting이 일어난 횟수
+  int nproc;                     // proc에 채워진 process 수
+  struct procstat proc[NPROC];   // 사용 중인 process들의 통계
+};
@@ -0,0 +1,330 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+#include "rusage.h"
+#include "trace.h"
+
+// 스케줄러 system call들이 약속한 동작을 확인하는 test program
+// 각 test는 실패하면 이유를 출력하고 바로 끝남
+
+#define NEV (NCPU * NTRACE)
+
+volatile int sink;               // 계산이 최적화로 사라지지 않게 함
+struct traceev ev[NEV];
+
+void failed()
+{
+  printf(1, "Test failed!\n");
+  exit();
+}
+
+// 잠시 계산만 하는 함수
+void spin(int n)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    sink += i;
+}
+
+// until tick이 될 때까지 user mode에서 계산만 하는 함수
+void spin_until(int until)
+{
+  while (uptime() < until)
+    spin(10000);
+}
+
+void test_rusage()
+{
+  struct rusage before, after;
+  int i;
+
+  // 계산만 하다가 끝난 자식의 utime이 RUSAGE_CHILDREN에 더해져야 함
+  if (getrusage(RUSAGE_CHILDREN, &before) < 0) {
+    printf(1, "getrusage failed\n");
+    failed();
+  }
+  if (fork() == 0) {
+    spin_until(uptime() + 20);
+    exit();
+  }
+  wait();
+  getrusage(RUSAGE_CHILDREN, &after);
+  if (after.utime == before.utime) {
+    printf(1, "Spinning child reported no user time\n");
+    failed();
+  }
+
+  // sleep할 때마다 자발적인 context switch가 세어져야 함
+  getrusage(RUSAGE_SELF, &before);
+  for (i = 0; i < 5; i++)
+    sleep(1);
+  getrusage(RUSAGE_SELF, &after);
+  if (after.nvcsw < before.nvcsw + 5) {
+    printf(1, "nvcsw went from %d to %d across 5 sleeps\n", before.nvcsw, after.nvcsw);
+    failed();
+  }
+
+  if (getrusage(7, &after) != -1) {
+    printf(1, "getrusage accepted an invalid who\n");
+    failed();
+  }
+}
+
+#define MEASURE 100              // 비율을 잴 때 함께 실행하는 tick 수
+
+// 다른 process와 같은 시각에 시작해서 MEASURE tick 동안 계산하고, 끝낸 일의 양을 fd로 보내고 끝나는 함수
+void measure(int fd, int idx, int start)
+{
+  int r[2];
+
+  spin_until(start);
+  r[0] = idx;
+  r[1] = 0;
+  while (uptime() < start + MEASURE) {
+    spin(1000);
+    r[1]++;
+  }
+  write(fd, r, sizeof(r));
+  exit();
+}
+
+// measure()를 실행한 n개 자식의 결과를 work[idx]로 모으는 함수
+void collect(int fd, int n, int *work)
+{
+  int i, r[2];
+
+  for (i = 0; i < n; i++) {
+    if (read(fd, r, sizeof(r)) != sizeof(r)) {
+      printf(1, "Worker did not report\n");
+      failed();
+    }
+    work[r[0]] = r[1];
+  }
+  close(fd);
+  for (i = 0; i < n; i++)
+    wait();
+}
+
+void test_stride()
+{
+  int tickets[2] = {100, 300};
+  int work[2], fd[2], i, start;
+
+  if (setstrideshare(0) != -1 || setstrideshare(100) != -1) {
+    printf(1, "setstrideshare accepted a share outside 1..99\n");
+    failed();
+  }
+  if (settickets(getpid(), -1) != -1 || settickets(getpid(), 100000) != -1) {
+    printf(1, "settickets accepted an invalid ticket count\n");
+    failed();
+  }
+
+  // stride heap은 cpu마다 있으므로 두 자식을 cpu 0에 묶어서 비율을 잼
+  pipe(fd);
+  start = uptime() + 5;
+  for (i = 0; i < 2; i++) {
+    if (fork() == 0) {
+      close(fd[0]);
+      if (sched_setaffinity(0, 1) < 0 || settickets(getpid(), tickets[i]) < 0) {
+        printf(1, "Cannot move worker into the stride class\n");
+        failed();
+      }
+      measure(fd[1], i, start);
+    }
+  }
+  close(fd[1]);
+  collect(fd[0], 2, work);
+  printf(1, "tickets %d:%d got work %d:%d\n", tickets[0], tickets[1], work[0], work[1]);
+  if (work[0] == 0 || work[1] < 2 * work[0] || work[1] > 4 * work[0]) {
+    printf(1, "Work split does not follow the 1:3 ticket ratio\n");
+    failed();
+  }
+}
+
+// 아직 읽지 않은 trace를 모두 버리는 함수
+void drain_trace()
+{
+  while (gettrace(ev, NEV) > 0)
+    ;
+}
+
+void test_affinity()
+{
+  int all, mask, pid[2], i, j, n, nrun = 0;
+
+  all = sched_getaffinity(0);
+  if (all <= 0) {
+    printf(1, "sched_getaffinity returned %d\n", all);
+    failed();
+  }
+  if (sched_setaffinity(0, 0) != -1 || sched_setaffinity(0, ~all) != -1) {
+    printf(1, "sched_setaffinity accepted a mask with no existing cpu\n");
+    failed();
+  }
+  if (sched_setaffinity(-1, all) != -1 || sched_getaffinity(-1) != -1) {
+    printf(1, "Affinity calls accepted a pid that does not exist\n");
+    failed();
+  }
+
+  // 가장 번호가 큰 cpu 하나에 묶은 두 자식은 다른 cpu가 놀고 있어도 그 cpu에서만 실행되어야 함
+  for (mask = 1; (mask << 1) <= all; mask <<= 1)
+    ;
+  drain_trace();
+  sched_setaffinity(0, mask);    // fork한 자식이 처음부터 mask를 물려받게 함
+  for (i = 0; i < 2; i++) {
+    if ((pid[i] = fork()) == 0) {
+      if (sched_getaffinity(0) != mask) {
+        printf(1, "Child did not inherit the affinity mask\n");
+        failed();
+      }
+      spin_until(uptime() + 30);
+      exit();
+    }
+  }
+  sched_setaffinity(0, all);
+  if (sched_getaffinity(0) != all) {
+    printf(1, "sched_getaffinity does not return the mask just set\n");
+    failed();
+  }
+  wait();
+  wait();
+  while ((n = gettrace(ev, NEV)) > 0) {
+    for (i = 0; i < n; i++) {
+      if (ev[i].type != TR_RUN)
+        continue;
+      for (j = 0; j < 2; j++) {
+        if (ev[i].pid != pid[j])
+          continue;
+        nrun++;
+        if (!((mask >> ev[i].cpu) & 1)) {
+          printf(1, "Pinned pid %d ran on cpu %d outside mask 0x%x\n", pid[j], ev[i].cpu, mask);
+          failed();
+        }
+      }
+    }
+  }
+  if (nrun == 0) {
+    printf(1, "No dispatch of the pinned children was traced\n");
+    failed();
+  }
+}
+
+void test_rt()
+{
+  int work[2], fd[2], i, start, total;
+
+  if (sched_setrt(10, 0) != -1 || sched_setrt(10, 11) != -1 || sched_setrt(-1, 1) != -1) {
+    printf(1, "sched_setrt accepted an invalid period or runtime\n");
+    failed();
+  }
+  if (sched_setrt(10, 9) != -1) {
+    printf(1, "sched_setrt admitted more than RTUTIL_MAX on one cpu\n");
+    failed();
+  }
+
+  // 주기 10 tick에 2 tick만 보장받은 real-time process가 budget을 다 쓰면 MLFQ로 내려와야
+  // 같은 cpu에서 계산만 하는 MLFQ process도 cpu를 받음
+  pipe(fd);
+  start = uptime() + 5;
+  for (i = 0; i < 2; i++) {
+    if (fork() == 0) {
+      close(fd[0]);
+      if (sched_setaffinity(0, 1) < 0 || (i == 0 && sched_setrt(10, 2) < 0)) {
+        printf(1, "Cannot set up the real-time worker\n");
+        failed();
+      }
+      measure(fd[1], i, start);
+    }
+  }
+  close(fd[1]);
+  collect(fd[0], 2, work);
+  total = work[0] + work[1];
+  printf(1, "real-time %d, mlfq %d\n", work[0], work[1]);
+  if (work[1] * 100 < total * 15) {
+    printf(1, "Real-time process was not throttled after using its budget\n");
+    failed();
+  }
+  if (work[0] * 100 < total * 20) {
+    printf(1, "Real-time process got less than its reserved 20%%\n");
+    failed();
+  }
+}
+
+#define NTARGET 3
+
+void test_yield_to()
+{
+  int pid[NTARGET], me = getpid(), i, j, k, n, found;
+
+  if (yield_to(me) != -1 || yield_to(-1) != -1) {
+    printf(1, "yield_to accepted itself or a pid that does not exist\n");
+    failed();
+  }
+
+  // 모두 cpu 0에 묶어 두고, 기다리는 자식들 중 지목한 자식이 바로 다음에 dispatch 되는지 trace로 확인
+  sched_setaffinity(0, 1);
+  yield();                       // cpu 0으로 옮김
+  for (i = 0; i < NTARGET; i++) {
+    if ((pid[i] = fork()) == 0) {
+      for (;;)
+        spin(10000);
+    }
+  }
+  sleep(2);
+  for (k = 0; k < 2 * NTARGET; k++) {
+    i = NTARGET - 1 - k % NTARGET;
+    drain_trace();
+    if (yield_to(pid[i]) != 0) {
+      printf(1, "yield_to(%d) failed although it is waiting on this cpu\n", pid[i]);
+      failed();
+    }
+    found = 0;
+    while ((n = gettrace(ev, NEV)) > 0) {
+      for (j = 0; j + 1 < n && !found; j++) {
+        if (ev[j].cpu != 0 || ev[j].type != TR_YIELD || ev[j].pid != me)
+          continue;
+        found = 1;
+        if (ev[j + 1].cpu != 0 || ev[j + 1].type != TR_RUN || ev[j + 1].pid != pid[i]) {
+          printf(1, "yield_to(%d) ran pid %d (event %d) next\n", pid[i], ev[j + 1].pid, ev[j + 1].type);
+          failed();
+        }
+      }
+    }
+    if (!found) {
+      printf(1, "yield_to(%d) was not traced\n", pid[i]);
+      failed();
+    }
+  }
+  for (i = 0; i < NTARGET; i++) {
+    kill(pid[i]);
+    wait();
+  }
+  sched_setaffinity(0, ~0);
+}
+
+int main(int argc, char *argv[])
+{
+  printf(1, "Test 1: getrusage test\n");
+  test_rusage();
+  printf(1, "Test 1 passed\n\n");
+
+  printf(1, "Test 2: Stride share test\n");
+  test_stride();
+  printf(1, "Test 2 passed\n\n");
+
+  printf(1, "Test 3: CPU affinity test\n");
+  test_affinity();
+  printf(1, "Test 3 passed\n\n");
+
+  printf(1, "Test 4: Real-time budget test\n");
+  test_rt();
+  printf(1, "Test 4 passed\n\n");
+
+  printf(1, "Test 5: yield_to test\n");
+  test_yield_to();
+  printf(1, "Test 5 passed\n\n");
+
+  printf(1, "All tests passed!\n");
+  exit();
+}
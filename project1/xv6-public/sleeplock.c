@@ -6,6 +6,8 @@
 #include "x86.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "spinlock.h"
 #include "sleeplock.h"
@@ -17,6 +19,7 @@ initsleeplock(struct sleeplock *lk, char *name)
   lk->name = name;
   lk->locked = 0;
   lk->pid = 0;
+  lk->holder = 0;
 }
 
 void
@@ -24,10 +27,14 @@ acquiresleep(struct sleeplock *lk)
 {
   acquire(&lk->lk);
   while (lk->locked) {
+    inherit_priority(lk);   // 기다리는 동안 lock을 가진 process에게 queue level을 빌려줌
     sleep(lk, &lk->lk);
   }
+  myproc()->pi_wait = 0;
+  myproc()->nsleeplock++;
   lk->locked = 1;
   lk->pid = myproc()->pid;
+  lk->holder = myproc();
   release(&lk->lk);
 }
 
@@ -37,6 +44,8 @@ releasesleep(struct sleeplock *lk)
   acquire(&lk->lk);
   lk->locked = 0;
   lk->pid = 0;
+  lk->holder = 0;
+  restore_priority();       // 빌려받은 queue level을 돌려줌
   wakeup(lk);
   release(&lk->lk);
 }
@@ -3,6 +3,8 @@
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "x86.h"
 #include "syscall.h"
@@ -109,6 +111,16 @@ extern int sys_getLevel(void);
 extern int sys_setPriority(void);
 extern int sys_schedulerLock(void);
 extern int sys_schedulerUnlock(void);
+extern int sys_getschedstat(void);
+extern int sys_getrusage(void);
+extern int sys_settickets(void);
+extern int sys_setstrideshare(void);
+extern int sys_sched_setaffinity(void);
+extern int sys_sched_getaffinity(void);
+extern int sys_mlfqpolicy(void);
+extern int sys_sched_setrt(void);
+extern int sys_gettrace(void);
+extern int sys_yield_to(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -138,6 +150,16 @@ static int (*syscalls[])(void) = {
 [SYS_setPriority] sys_setPriority,
 [SYS_schedulerLock] sys_schedulerLock,
 [SYS_schedulerUnlock] sys_schedulerUnlock,
+[SYS_getschedstat] sys_getschedstat,
+[SYS_getrusage] sys_getrusage,
+[SYS_settickets] sys_settickets,
+[SYS_setstrideshare] sys_setstrideshare,
+[SYS_sched_setaffinity] sys_sched_setaffinity,
+[SYS_sched_getaffinity] sys_sched_getaffinity,
+[SYS_mlfqpolicy] sys_mlfqpolicy,
+[SYS_sched_setrt] sys_sched_setrt,
+[SYS_gettrace] sys_gettrace,
+[SYS_yield_to] sys_yield_to,
 };
 
 void
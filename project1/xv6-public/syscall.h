@@ -25,4 +25,14 @@
 #define SYS_getLevel 24
 #define SYS_setPriority 25
 #define SYS_schedulerLock 26
-#define SYS_schedulerUnlock 27
\ No newline at end of file
+#define SYS_schedulerUnlock 27
+#define SYS_getschedstat 28
+#define SYS_getrusage 29
+#define SYS_settickets 30
+#define SYS_setstrideshare 31
+#define SYS_sched_setaffinity 32
+#define SYS_sched_getaffinity 33
+#define SYS_mlfqpolicy 34
+#define SYS_sched_setrt 35
+#define SYS_gettrace 36
+#define SYS_yield_to 37
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include "param.h"
 #include "stat.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "fs.h"
 #include "spinlock.h"
@@ -5,7 +5,10 @@
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
+#include "timer.h"
 
 int
 sys_fork(void)
@@ -61,17 +64,22 @@ sys_sleep(void)
 {
   int n;
   uint ticks0;
+  struct timer t;
 
   if(argint(0, &n) < 0)
     return -1;
   acquire(&tickslock);
   ticks0 = ticks;
+  t.pending = 0;
+  if(n > 0)
+    timer_add(&t, ticks0 + n, wakeup, &t);  // 매 tick이 아니라 만료될 때만 깨어나도록 자신의 timer에서 잠듦
   while(ticks - ticks0 < n){
     if(myproc()->killed){
+      timer_del(&t);
       release(&tickslock);
       return -1;
     }
-    sleep(&ticks, &tickslock);
+    sleep(&t, &tickslock);
   }
   release(&tickslock);
   return 0;
@@ -0,0 +1,74 @@
+// Timer wheel.
+// timer는 만료 tick을 NTIMERSLOT으로 나눈 나머지 slot에 들어가고,
+// 매 tick마다 그 tick의 slot만 확인하므로 만료된 timer만 처리됨
+// (slot을 한 바퀴 이상 남긴 timer는 expire가 다르므로 건너뜀)
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "spinlock.h"
+#include "timer.h"
+
+#define NTIMERSLOT 64
+
+static struct timer *wheel[NTIMERSLOT];
+
+// t를 wheel에서 빼는 함수, 들어있지 않으면 아무것도 하지 않음
+void
+timer_del(struct timer *t)
+{
+  if(!holding(&tickslock))
+    panic("timer_del");
+  if(!t->pending)
+    return;
+  if(t->prev)
+    t->prev->next = t->next;
+  else
+    wheel[t->expire % NTIMERSLOT] = t->next;
+  if(t->next)
+    t->next->prev = t->prev;
+  t->next = 0;
+  t->prev = 0;
+  t->pending = 0;
+}
+
+// expire tick이 되면 fn(arg)를 호출하도록 t를 wheel에 넣는 함수
+// 이미 지난 tick이라면 다음 tick에 호출됨
+void
+timer_add(struct timer *t, uint expire, void (*fn)(void*), void *arg)
+{
+  struct timer **slot;
+
+  if(!holding(&tickslock))
+    panic("timer_add");
+  timer_del(t);
+  if((int)(expire - ticks) <= 0)
+    expire = ticks + 1;
+  t->expire = expire;
+  t->fn = fn;
+  t->arg = arg;
+  slot = &wheel[expire % NTIMERSLOT];
+  t->prev = 0;
+  t->next = *slot;
+  if(*slot)
+    (*slot)->prev = t;
+  *slot = t;
+  t->pending = 1;
+}
+
+// 이번 tick에 만료된 timer들을 wheel에서 빼고 fn을 호출하는 함수
+// timer interrupt에서 ticks를 증가시킨 직후에 호출됨
+// fn 안에서 다른 timer를 넣거나 빼면 안 됨
+void
+timer_expire(void)
+{
+  struct timer *t, *next;
+
+  for(t = wheel[ticks % NTIMERSLOT]; t; t = next){
+    next = t->next;
+    if(t->expire == ticks){
+      timer_del(t);
+      t->fn(t->arg);
+    }
+  }
+}
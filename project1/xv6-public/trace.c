@@ -0,0 +1,101 @@
+// Context switch trace.
+// cpu마다 ring buffer를 두고, 기록은 interrupt를 끈 상태에서 자기 cpu의 ring에만 하므로 lock이 필요 없음
+// gettrace()는 다른 cpu가 기록하는 도중에 읽을 수 있으므로,
+// 복사한 뒤 head를 다시 읽어 그 사이에 덮어써졌을 수 있는 entry는 버림
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "rusage.h"
+#include "mlfq.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "trace.h"
+
+static struct {
+  struct traceev ev[NTRACE];
+  volatile uint head;            // 다음에 기록할 위치 (계속 증가함)
+  uint tail;                     // 다음에 gettrace()로 읽어갈 위치
+} ring[NCPU];
+
+static uint seq;                 // 다음 trace의 순서
+static struct spinlock tracelock;  // gettrace()끼리만 막음
+
+void
+traceinit(void)
+{
+  initlock(&tracelock, "trace");
+}
+
+// 현재 cpu의 ring에 type 종류의 trace를 기록하는 함수 (p가 0이면 pid 0으로 기록)
+void
+trace(int type, struct proc *p)
+{
+  struct traceev *e;
+  int c;
+
+  pushcli();
+  c = cpuid();
+  e = &ring[c].ev[ring[c].head % NTRACE];
+  e->seq = __sync_fetch_and_add(&seq, 1);
+  e->tick = ticks;
+  e->pid = p ? p->pid : 0;
+  e->cpu = c;
+  e->type = type;
+  e->q_level = p ? p->q_level : 0;
+  e->priority = p ? p->priority : 0;
+  __sync_synchronize();          // entry를 다 쓴 뒤에 head를 늘림
+  ring[c].head++;
+  popcli();
+}
+
+// 아직 읽지 않은 trace를 최대 n개까지 buf로 옮기고 옮긴 개수를 반환하는 함수
+// cpu별로 오래된 것부터 담기며, 전체 순서는 seq로 알 수 있음
+int
+gettrace(struct traceev *buf, int n)
+{
+  int i, cnt = 0, base, lost;
+  uint head, start, j;
+
+  acquire(&tracelock);
+  for(i = 0; i < ncpu && cnt < n; i++){
+    head = ring[i].head;
+    __sync_synchronize();
+    start = ring[i].tail;
+    if(head - start > NTRACE)    // 읽기 전에 덮어써진 것은 버림
+      start = head - NTRACE;
+    base = cnt;
+    for(j = start; j != head && cnt < n; j++)
+      buf[cnt++] = ring[i].ev[j % NTRACE];
+    __sync_synchronize();
+    lost = (int)(ring[i].head - NTRACE - start);  // 복사하는 동안 덮어써졌을 수 있는 개수
+    if(lost > cnt - base)
+      lost = cnt - base;
+    if(lost > 0){
+      memmove(&buf[base], &buf[base + lost], (cnt - base - lost) * sizeof(*buf));
+      cnt -= lost;
+    }
+    ring[i].tail = j;
+  }
+  release(&tracelock);
+  return cnt;
+}
+
+// gettrace 함수의 system call 함수
+int
+sys_gettrace(void)
+{
+  struct traceev *buf;
+  int n;
+
+  if(argint(1, &n) < 0 || n < 0)
+    return -1;
+  if(n > NCPU * NTRACE)          // 한 번에 옮길 수 있는 최대 개수
+    n = NCPU * NTRACE;
+  if(argptr(0, (void*)&buf, n * sizeof(*buf)) < 0)
+    return -1;
+  return gettrace(buf, n);
+}
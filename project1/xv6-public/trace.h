@@ -0,0 +1,26 @@
+// gettrace()로 받아오는 context switch trace
+// cpu마다 NTRACE개까지 저장하고, 다 차면 가장 오래된 것부터 덮어씀
+
+#define NTRACE 256               // cpu마다 저장하는 trace 수
+
+// trace 종류
+#define TR_RUN     1             // scheduler가 process를 dispatch 함
+#define TR_YIELD   2             // 스스로 yield 해서 scheduler로 돌아옴
+#define TR_PREEMPT 3             // timer interrupt로 scheduler로 돌아옴
+#define TR_QUANTUM 4             // time quantum을 다 써서 level이나 priority가 바뀜
+#define TR_SLEEP   5             // 잠들어서 scheduler로 돌아옴
+#define TR_EXIT    6             // 종료되어 scheduler로 돌아옴
+#define TR_WAKEUP  7             // wakeup()으로 RUNNABLE이 됨
+#define TR_BOOST   8             // priority boosting이 일어남 (pid는 0)
+#define TR_LOCK    9             // schedulerLock()으로 lock을 얻음
+#define TR_UNLOCK 10             // schedulerUnlock()으로 lock을 놓음
+
+struct traceev {
+  uint seq;                      // 모든 cpu를 통틀어 기록된 순서
+  uint tick;                     // 기록된 시점의 ticks
+  int pid;                       // 해당 process의 pid
+  uchar cpu;                     // 기록한 cpu
+  uchar type;                    // trace 종류 (TR_*)
+  uchar q_level;                 // 기록된 시점의 queue level
+  uchar priority;                // 기록된 시점의 priority
+};
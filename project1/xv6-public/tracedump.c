@@ -0,0 +1,78 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+#include "trace.h"
+
+// 사용법: tracedump [command args...]
+// kernel에 쌓인 context switch trace를 모든 cpu에 대해 기록된 순서대로 출력
+// command가 주어지면 그 전까지의 trace는 버리고, 실행이 끝날 때까지 기다린 뒤 출력
+
+#define NEV (NCPU * NTRACE)
+
+static char *types[] = {
+[TR_RUN]     "run",
+[TR_YIELD]   "yield",
+[TR_PREEMPT] "preempt",
+[TR_QUANTUM] "quantum",
+[TR_SLEEP]   "sleep",
+[TR_EXIT]    "exit",
+[TR_WAKEUP]  "wakeup",
+[TR_BOOST]   "boost",
+[TR_LOCK]    "lock",
+[TR_UNLOCK]  "unlock",
+};
+
+struct traceev ev[NEV];
+
+// cpu별로 나뉘어 온 trace를 seq 순으로 정렬하는 함수
+// cpu마다 이미 정렬되어 있으므로 insertion sort로 충분함
+void
+sort(int n)
+{
+  struct traceev t;
+  int i, j;
+
+  for(i = 1; i < n; i++){
+    t = ev[i];
+    for(j = i; j > 0 && (int)(ev[j-1].seq - t.seq) > 0; j--)
+      ev[j] = ev[j-1];
+    ev[j] = t;
+  }
+}
+
+int
+main(int argc, char *argv[])
+{
+  int i, n, pid;
+
+  if(argc > 1){
+    while(gettrace(ev, NEV) > 0)   // 이전 trace는 버림
+      ;
+    pid = fork();
+    if(pid < 0){
+      printf(2, "tracedump: fork failed\n");
+      exit();
+    }
+    if(pid == 0){
+      exec(argv[1], argv + 1);
+      printf(2, "tracedump: exec %s failed\n", argv[1]);
+      exit();
+    }
+    wait();
+  }
+
+  if((n = gettrace(ev, NEV)) < 0){
+    printf(2, "tracedump: gettrace failed\n");
+    exit();
+  }
+  sort(n);
+  printf(1, "tick cpu pid event level prio\n");
+  for(i = 0; i < n; i++){
+    printf(1, "%d %d %d %s", ev[i].tick, ev[i].cpu, ev[i].pid, types[ev[i].type]);
+    if(ev[i].pid)
+      printf(1, " L%d %d", ev[i].q_level, ev[i].priority);
+    printf(1, "\n");
+  }
+  exit();
+}
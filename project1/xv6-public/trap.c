@@ -3,10 +3,13 @@
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "x86.h"
 #include "traps.h"
 #include "spinlock.h"
+#include "trace.h"
 
 // Interrupt descriptor table (shared by all CPUs).
 struct gatedesc idt[256];
@@ -61,14 +64,23 @@ trap(struct trapframe *tf)
 
   switch(tf->trapno){
   case T_IRQ0 + IRQ_TIMER:
+    if(myproc()){                    // 실행 중이던 process의 CPU 사용 시간 1 증가
+      if((tf->cs&3) == DPL_USER)
+        myproc()->ru.utime++;
+      else
+        myproc()->ru.stime++;
+    }
     if(cpuid() == 0){
       acquire(&tickslock);
       ticks++;
-      wakeup(&ticks);
+      timer_expire();                // 이번 tick에 만료된 timer만 처리
       release(&tickslock);
     }
     lapiceoi();
     break;
+  case T_IRQ0 + IRQ_WAKEUP:
+    lapiceoi();
+    break;
   case T_IRQ0 + IRQ_IDE:
     ideintr();
     lapiceoi();
@@ -100,6 +112,8 @@ trap(struct trapframe *tf)
       panic("trap");
     }
     // In user space, assume process misbehaved.
+    if(tf->trapno == T_PGFLT)   // demand paging이 없으므로 page fault는 항상 kill로 이어짐
+      myproc()->ru.nfault++;
     cprintf("pid %d %s: trap %d err %d on cpu %d "
             "eip 0x%x addr 0x%x--kill proc\n",
             myproc()->pid, myproc()->name, tf->trapno,
@@ -118,20 +132,32 @@ trap(struct trapframe *tf)
   if(myproc() && myproc()->state == RUNNING && tf->trapno == T_IRQ0+IRQ_TIMER){
     global_ticks++;                                                     // global_tick 1 증가
     myproc()->t_quantum++;                                              // 해당 process의 time quantum 1 증가
+    myproc()->run_ticks[myproc()->q_level]++;                           // 현재 level에서 실행한 시간 1 증가
 
-    if(myproc()->t_quantum == 2*(myproc()->q_level)+4){                 // 만약 해당 process의 time quantum이 2*n + 4일 경우
-      if(myproc()->q_level == 2){                                       // L2 queue에 있는 process라면
-        if(myproc()->priority != 0){                                    // priority가 0이 아니라면
-          setPriority(myproc()->pid, (myproc()->priority)-1);           // priority를 1 감소
+    if(myproc()->rt_period && !myproc()->rt_throttled)                  // real-time class process라면
+      rt_charge(myproc());                                              // budget을 1 줄이고, 다 쓰면 다음 주기까지 MLFQ로 실행
+    else if(myproc()->tickets == 0 &&                                   // MLFQ class process이고
+       myproc()->t_quantum >= mlfq.quantum[myproc()->q_level]){         // 만약 해당 process가 level의 time quantum을 다 썼을 경우
+      trace(TR_QUANTUM, myproc());                                      // level이나 priority가 바뀌기 전에 기록
+      if(myproc()->q_level >= mlfq.nlevel - 1){                         // 마지막 level queue에 있는 process라면
+        if(mlfq.aging && myproc()->priority != 0){                      // aging을 하고 priority가 0이 아니라면
+          if(myproc()->priority > mlfq.aging)                           // priority를 aging만큼 감소 (0보다 작아지지 않게)
+            setPriority(myproc()->pid, myproc()->priority - mlfq.aging);
+          else
+            setPriority(myproc()->pid, 0);
         }
         myproc()->t_quantum = 0;                                        // 해당 process의 time quantum을 0으로 초기화
       }
       else{                                                             // 만약 L0나 L1 queue에 있는 process라면
         myproc()->q_level++;                                            // queue level을 1 증가
+        account_demote(myproc());                                       // demotion 횟수 기록
         myproc()->t_quantum = 0;                                        // 해당 process의 time quantum을 0으로 초기화
         myproc()->order = MLFQ_order[myproc()->q_level]++;              // 해당 process의 순서를 해당 queue의 마지막으로 보냄
       }
     }
+    if(mlfq.boost && global_ticks >= mlfq.boost)                        // global_ticks이 boosting 주기가 되었다면
+      priority_boosting();                                              // Starvation을 막기 위해 priority boosting
+    myproc()->preempted = 1;                                            // 실제로 바뀌면 sched()에서 비자발적인 context switch로 셈
     yield();                                                            // 다음 process에게 CPU를 양보
   }
 
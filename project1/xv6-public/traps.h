@@ -34,5 +34,6 @@
 #define IRQ_COM1         4
 #define IRQ_IDE         14
 #define IRQ_ERROR       19
+#define IRQ_WAKEUP      30      // 멈춰 있는 cpu를 깨우는 IPI
 #define IRQ_SPURIOUS    31
 
@@ -9,6 +9,8 @@
 #include "fs.h"
 #include "file.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "x86.h"
 
@@ -1,5 +1,9 @@
 struct stat;
 struct rtcdate;
+struct rusage;
+struct schedstat;
+struct mlfqpolicy;
+struct traceev;
 
 // system calls
 int fork(void);
@@ -29,6 +33,16 @@ int getLevel(void);
 void setPriority(int pid, int priority);
 void schedulerLock(int password);
 void schedulerUnlock(int password);
+int getschedstat(struct schedstat*);
+int getrusage(int, struct rusage*);
+int settickets(int pid, int tickets);
+int setstrideshare(int share);
+int sched_setaffinity(int pid, int mask);
+int sched_getaffinity(int pid);
+int mlfqpolicy(struct mlfqpolicy*, struct mlfqpolicy*);
+int sched_setrt(int period, int runtime);
+int gettrace(struct traceev*, int);
+int yield_to(int pid);
 
 // ulib.c
 int stat(const char*, struct stat*);
@@ -4,6 +4,8 @@
 #include "x86.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "mlfq.h"
 #include "proc.h"
 #include "elf.h"
 
@@ -16,17 +18,30 @@ void
 seginit(void)
 {
   struct cpu *c;
+  int apicid;
+
+  // %gs가 아직 잡혀있지 않아 mycpu()를 쓸 수 없으므로 APIC ID로 찾음
+  apicid = lapicid();
+  for(c = cpus; c < &cpus[ncpu] && c->apicid != apicid; c++)
+    ;
+  if(c == &cpus[ncpu])
+    panic("unknown apicid\n");
 
   // Map "logical" addresses to virtual addresses using identity map.
   // Cannot share a CODE descriptor for both kernel and user
   // because it would have to have DPL_USR, but the CPU forbids
   // an interrupt from CPL=0 to DPL=3.
-  c = &cpus[cpuid()];
   c->gdt[SEG_KCODE] = SEG(STA_X|STA_R, 0, 0xffffffff, 0);
   c->gdt[SEG_KDATA] = SEG(STA_W, 0, 0xffffffff, 0);
   c->gdt[SEG_UCODE] = SEG(STA_X|STA_R, 0, 0xffffffff, DPL_USER);
   c->gdt[SEG_UDATA] = SEG(STA_W, 0, 0xffffffff, DPL_USER);
+
+  // Map cpu-local storage: %gs:0 is c->self, %gs:4 is c->proc.
+  c->gdt[SEG_KCPU] = SEG(STA_W, &c->self, 8, 0);
+
   lgdt(c->gdt, sizeof(c->gdt));
+  loadgs(SEG_KCPU << 3);
+  c->self = c;
 }
 
 // Return the address of the PTE in page table pgdir
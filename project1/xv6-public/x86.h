@@ -117,6 +117,14 @@ sti(void)
   asm volatile("sti");
 }
 
+// interrupt를 켜고 다음 interrupt가 올 때까지 cpu를 멈춤
+// sti 바로 다음 명령어까지는 interrupt가 들어오지 않으므로 그 사이에 온 interrupt도 놓치지 않음
+static inline void
+stihlt(void)
+{
+  asm volatile("sti; hlt");
+}
+
 static inline uint
 xchg(volatile uint *addr, uint newval)
 {
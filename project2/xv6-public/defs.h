@@ -2,12 +2,15 @@ struct buf;
 struct context;
 struct file;
 struct inode;
+struct mm;
 struct pipe;
 struct proc;
 struct rtcdate;
+struct rusage;
 struct spinlock;
 struct sleeplock;
 struct stat;
+struct timer;
 struct superblock;
 
 // bio.c
@@ -35,6 +38,18 @@ int             fileread(struct file*, char*, int n);
 int             filestat(struct file*, struct stat*);
 int             filewrite(struct file*, char*, int n);
 
+// fpu.c
+void            fpuinit(void);
+void            fpu_trap(void);
+void            fpu_switchin(struct proc*);
+void            fpu_switchout(struct proc*);
+void            fpu_copy(struct proc*, struct proc*);
+void            fpu_reset(struct proc*);
+
+// futex.c
+void            futexinit(void);
+void            futex_drop(pde_t*);
+
 // fs.c
 void            readsb(int dev, struct superblock *sb);
 int             dirlink(struct inode*, char*, uint);
@@ -79,6 +94,8 @@ int             lapicid(void);
 extern volatile uint*    lapic;
 void            lapiceoi(void);
 void            lapicinit(void);
+void            lapicipi(int, int);
+void            lapictimer(int);
 void            lapicstartap(uchar, uint);
 void            microdelay(int);
 
@@ -127,6 +144,12 @@ int             thread_create(thread_t *thread, void *(*start_routine)(void *),
 void            thread_exit(void *retval);
 int             thread_join(thread_t thread, void **retval);
 void            exec_exit(int pid, int tid);
+void            exec_commit(struct proc*, pde_t*, uint);
+void            mm_put(struct mm*);
+int             thread_stack_trim(void);
+int             getrusage(int, struct rusage*);
+int             setgang(int);
+int             gang_preempt(struct proc*);
 
 // swtch.S
 void            swtch(struct context**, struct context*);
@@ -165,6 +188,9 @@ void            syscall(void);
 
 // timer.c
 void            timerinit(void);
+void            timer_add(struct timer*, uint, void (*)(void*), void*);
+void            timer_del(struct timer*);
+void            timer_expire(void);
 
 // trap.c
 void            idtinit(void);
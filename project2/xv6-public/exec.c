@@ -2,6 +2,8 @@
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "spinlock.h"
 #include "proc.h"
 #include "defs.h"
 #include "x86.h"
@@ -16,7 +18,7 @@ exec(char *path, char **argv)
   struct elfhdr elf;
   struct inode *ip;
   struct proghdr ph;
-  pde_t *pgdir, *oldpgdir;
+  pde_t *pgdir;
   struct proc *curproc = myproc();
 
   begin_op();
@@ -94,16 +96,10 @@ exec(char *path, char **argv)
   safestrcpy(curproc->name, last, sizeof(curproc->name));
 
   // Commit to the user image.
-  oldpgdir = curproc->pgdir;
-  curproc->pgdir = pgdir;
-  curproc->sz = sz;
+  exec_commit(curproc, pgdir, sz);
   curproc->tf->eip = elf.entry;  // main
   curproc->tf->esp = sp;
   curproc->stack_size = 1;       // stack용 page의 개수
-  switchuvm(curproc);
-  freevm(oldpgdir);
-
-  exec_exit(curproc->pid, curproc->tid); // pid가 같으면서 tid가 다른 thread 정리
   curproc->tid = 0;
   curproc->called = curproc;
   curproc->retval = 0;
@@ -130,7 +126,7 @@ exec2(char *path, char **argv, int stacksize)
   struct elfhdr elf;
   struct inode *ip;
   struct proghdr ph;
-  pde_t *pgdir, *oldpgdir;
+  pde_t *pgdir;
   struct proc *curproc = myproc();
 
   begin_op();
@@ -211,14 +207,13 @@ exec2(char *path, char **argv, int stacksize)
   safestrcpy(curproc->name, last, sizeof(curproc->name));
 
   // Commit to the user image.
-  oldpgdir = curproc->pgdir;
-  curproc->pgdir = pgdir;
-  curproc->sz = sz;
+  exec_commit(curproc, pgdir, sz);
   curproc->tf->eip = elf.entry;  // main
   curproc->tf->esp = sp;
   curproc->stack_size = stacksize;       // stack용 page의 개수
-  switchuvm(curproc);
-  freevm(oldpgdir);
+  curproc->tid = 0;
+  curproc->called = curproc;
+  curproc->retval = 0;
   return 0;
 
  bad:
@@ -0,0 +1,97 @@
+// x87/SSE state.
+// process마다 fxsave 영역을 두고, dispatch 할 때는 CR0.TS만 켜 두었다가
+// process가 처음 FPU 명령어를 쓸 때 T_DEVICE trap에서 상태를 복원함 (lazy restore)
+// FPU를 쓴 process는 cpu를 내놓을 때 바로 저장하므로, 다른 cpu로 옮겨가도 p->fpu가 항상 최신임
+// 같은 cpu로 돌아왔는데 그 사이 아무도 FPU를 쓰지 않았다면 register에 남은 상태를 그대로 씀
+// kernel은 FPU를 쓰지 않으므로 아래 함수들 외에는 FPU 명령어를 실행하지 않음
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "rusage.h"
+#include "spinlock.h"
+#include "proc.h"
+
+// 이 cpu에서 x87/SSE를 쓸 수 있게 하는 함수 (각 cpu가 mpmain에서 호출)
+// FPU 오류는 T_FPERR, SSE 오류는 T_SIMDERR로 받아 trap()에서 process를 종료함
+void
+fpuinit(void)
+{
+  lcr4(rcr4() | CR4_OSFXSR | CR4_OSXMMEXCPT);
+  lcr0((rcr0() & ~CR0_EM) | CR0_MP | CR0_NE | CR0_TS);
+}
+
+// 현재 process가 CR0.TS가 켜진 상태에서 FPU 명령어를 써서 T_DEVICE trap이 났을 때 호출
+// 저장해 둔 상태를 복원하거나, 처음 쓰는 것이라면 초기 상태로 만듦
+// interrupt가 꺼진 상태에서 호출됨
+void
+fpu_trap(void)
+{
+  struct cpu *c = mycpu();
+  struct proc *p = myproc();
+
+  clts();
+  if(p->fpu_used)
+    fxrstor(p->fpu);
+  else {
+    fpureset();
+    p->fpu_used = 1;
+  }
+  c->fpu_owner = p;
+  p->fpu_cpu = c;
+}
+
+// p를 dispatch 하기 직전에 호출하는 함수
+// 이 cpu의 register에 p의 상태가 그대로 남아 있으면 trap 없이 쓰게 하고, 아니면 첫 사용 때 trap이 나게 함
+void
+fpu_switchin(struct proc *p)
+{
+  struct cpu *c = mycpu();
+
+  if(c->fpu_owner == p && p->fpu_cpu == c)
+    clts();
+  else
+    lcr0(rcr0() | CR0_TS);
+}
+
+// p가 cpu를 내놓기 직전에 호출하는 함수
+// 이번에 실행하는 동안 FPU를 썼다면 (CR0.TS가 꺼져 있다면) p->fpu에 저장함
+void
+fpu_switchout(struct proc *p)
+{
+  if(rcr0() & CR0_TS)
+    return;
+  fxsave(p->fpu);
+  lcr0(rcr0() | CR0_TS);
+}
+
+// fork, thread_create로 만든 np가 현재 process p의 FPU 상태를 물려받게 하는 함수
+// p가 실행 중에 FPU를 썼다면 register의 상태를 먼저 p->fpu에 저장함
+void
+fpu_copy(struct proc *np, struct proc *p)
+{
+  pushcli();                   // 저장하는 도중 선점되어 CR0.TS가 바뀌지 않게 함
+  if(!(rcr0() & CR0_TS))
+    fxsave(p->fpu);
+  popcli();
+  memmove(np->fpu, p->fpu, sizeof(np->fpu));
+  np->fpu_used = p->fpu_used;
+  np->fpu_cpu = 0;
+}
+
+// exec으로 새 program을 실행하는 p의 FPU 상태를 버리는 함수
+// 다음에 FPU를 쓸 때 초기 상태로 시작함
+void
+fpu_reset(struct proc *p)
+{
+  pushcli();
+  p->fpu_used = 0;
+  p->fpu_cpu = 0;
+  if(mycpu()->fpu_owner == p)
+    mycpu()->fpu_owner = 0;
+  lcr0(rcr0() | CR0_TS);
+  popcli();
+}
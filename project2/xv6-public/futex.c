@@ -0,0 +1,224 @@
+// Futex.
+// 같은 pgdir을 쓰는 thread들이 user 주소의 int 값을 기준으로 잠들고 깨우는 system call
+// 경쟁이 없을 때는 user 공간에서 값만 바꾸고, 기다려야 할 때만 kernel로 들어옴
+// 기다리는 thread는 (pgdir, user 주소)로 hash한 bucket에 연결되며, 모든 bucket은 futex.lock으로 보호됨
+// lock 순서는 tickslock -> futex.lock -> p->lock (timeout timer가 tickslock을 잡은 채로 futex.lock을 잡음)
+// user 값은 futex.lock -> mm->lock 순서로 mm->lock을 잡고 읽어 형제 thread의 sbrk(-n)와 겹치지 않게 함
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "rusage.h"
+#include "spinlock.h"
+#include "proc.h"
+#include "timer.h"
+
+#define NFUTEXQ 31
+
+static struct {
+  struct spinlock lock;
+  struct proc *q[NFUTEXQ];     // (pgdir, addr)로 hash한 기다리는 thread들의 list
+} futex;
+
+// timeout이 있는 futex_wait이 timer에 넘기는 정보 (기다리는 thread의 kernel stack에 있음)
+struct futexwait {
+  struct proc *p;
+  int timedout;                // timeout이 지났으면 1 (futex.lock으로 보호)
+};
+
+void
+futexinit(void)
+{
+  initlock(&futex.lock, "futex");
+}
+
+static struct proc**
+futexq(pde_t *pgdir, uint addr)
+{
+  return &futex.q[((uint)pgdir ^ (addr >> 2)) % NFUTEXQ];
+}
+
+// user 주소 addr의 int 값을 *val에 읽어 오는 함수 (futex.lock을 잡은 상태에서 호출)
+// 형제 thread가 sbrk(-n)로 그 page를 이미 해제했으면 -1을 반환
+static int
+futex_load(struct mm *mm, uint addr, int *val)
+{
+  char *mem;
+
+  acquire(&mm->lock);          // 읽는 동안 growproc이 page를 해제하지 못하게 함
+  if(addr >= mm->sz || (mem = uva2ka(mm->pgdir, (char*)addr)) == 0){
+    release(&mm->lock);
+    return -1;
+  }
+  *val = *(int*)(mem + (addr & (PGSIZE-1))); // 정렬된 주소이므로 page를 넘지 않음
+  release(&mm->lock);
+  return 0;
+}
+
+// 기다리던 p를 bucket에서 빼는 함수 (futex.lock을 잡은 상태에서 호출)
+static void
+futex_unlink(struct proc *p)
+{
+  struct proc **pp;
+
+  for(pp = futexq(p->futex_pgdir, p->futex_addr); *pp; pp = &(*pp)->futex_next){
+    if(*pp == p){
+      *pp = p->futex_next;
+      break;
+    }
+  }
+  p->futex_next = 0;
+  p->futex_pgdir = 0;
+}
+
+// futex_wait의 timeout이 지났을 때 timer에서 호출되는 함수 (tickslock을 잡은 상태)
+// 아직 bucket에 들어가기 전일 수도 있으므로 지났다는 것만 남기고 깨움
+// bucket에서 빼는 것은 futex_wait이 timedout을 보고 직접 함
+static void
+futex_timeout(void *arg)
+{
+  struct futexwait *w = arg;
+
+  acquire(&futex.lock);
+  w->timedout = 1;
+  wakeup(&w->p->futex_addr);
+  release(&futex.lock);
+}
+
+// *addr이 expected이면 futex_wake로 깨워질 때까지 잠드는 함수
+// timeout이 0보다 크면 그 tick이 지나면 깨어남
+// 깨워졌으면 0, *addr이 expected가 아니거나 해제된 page이거나 kill 되었으면 -1, timeout이 지났으면 -2를 반환
+int
+futex_wait(int *addr, int expected, int timeout)
+{
+  struct proc *p = myproc();
+  struct proc **q;
+  struct futexwait w;
+  struct timer t;
+  int r = 0, val;
+
+  w.p = p;
+  w.timedout = 0;
+  t.pending = 0;
+  if(timeout > 0){             // futex.lock을 잡기 전에 timer를 걸어 lock 순서를 지킴
+    acquire(&tickslock);
+    timer_add(&t, ticks + timeout, futex_timeout, &w);
+    release(&tickslock);
+  }
+
+  acquire(&futex.lock);
+  // 값을 확인하는 것과 잠드는 것 사이에 futex_wake가 끼어들 수 없음
+  if(futex_load(p->mm, (uint)addr, &val) < 0 || val != expected){
+    r = -1;
+    goto out;
+  }
+  if(w.timedout){              // futex.lock을 잡기 전에 이미 timeout이 지남
+    r = -2;
+    goto out;
+  }
+  p->futex_pgdir = p->mm->pgdir;
+  p->futex_addr = (uint)addr;
+  q = futexq(p->futex_pgdir, p->futex_addr);
+  p->futex_next = *q;
+  *q = p;
+  while(p->futex_pgdir){       // futex_wake나 timeout이 bucket에서 빼줄 때까지
+    if(p->killed){
+      futex_unlink(p);
+      r = -1;
+      goto out;
+    }
+    if(w.timedout){
+      futex_unlink(p);
+      r = -2;
+      goto out;
+    }
+    sleep(&p->futex_addr, &futex.lock);
+  }
+
+out:
+  release(&futex.lock);
+  if(timeout > 0){
+    acquire(&tickslock);
+    timer_del(&t);
+    release(&tickslock);
+  }
+  return r;
+}
+
+// addr에서 기다리는 thread를 최대 n개 깨우고 깨운 수를 반환하는 함수
+int
+futex_wake(int *addr, int n)
+{
+  struct proc *p, **pp;
+  pde_t *pgdir = myproc()->mm->pgdir;
+  int woken = 0;
+
+  acquire(&futex.lock);
+  pp = futexq(pgdir, (uint)addr);
+  while((p = *pp) != 0 && woken < n){
+    if(p->futex_pgdir != pgdir || p->futex_addr != (uint)addr){ // hash가 겹친 다른 futex
+      pp = &p->futex_next;
+      continue;
+    }
+    *pp = p->futex_next;
+    p->futex_next = 0;
+    p->futex_pgdir = 0;
+    wakeup(&p->futex_addr);
+    woken++;
+  }
+  release(&futex.lock);
+  return woken;
+}
+
+// pgdir을 쓰던 thread들이 정리될 때 futex에서 기다리던 것을 모두 빼는 함수
+// exit, exec에서 형제 thread를 정리하기 전에 호출함
+void
+futex_drop(pde_t *pgdir)
+{
+  struct proc *p, **pp;
+  int i;
+
+  acquire(&futex.lock);
+  for(i = 0; i < NFUTEXQ; i++){
+    pp = &futex.q[i];
+    while((p = *pp) != 0){
+      if(p->futex_pgdir != pgdir){
+        pp = &p->futex_next;
+        continue;
+      }
+      *pp = p->futex_next;
+      p->futex_next = 0;
+      p->futex_pgdir = 0;
+    }
+  }
+  release(&futex.lock);
+}
+
+// futex_wait 함수의 system call 함수
+int
+sys_futex_wait(void)
+{
+  int *addr, expected, timeout;
+
+  if(argptr(0, (void*)&addr, sizeof(*addr)) < 0 || argint(1, &expected) < 0 || argint(2, &timeout) < 0)
+    return -1;
+  if((uint)addr % sizeof(*addr))   // 정렬되지 않은 주소는 받지 않음
+    return -1;
+  return futex_wait(addr, expected, timeout);
+}
+
+// futex_wake 함수의 system call 함수
+int
+sys_futex_wake(void)
+{
+  int *addr, n;
+
+  if(argptr(0, (void*)&addr, sizeof(*addr)) < 0 || argint(1, &n) < 0)
+    return -1;
+  if((uint)addr % sizeof(*addr))
+    return -1;
+  return futex_wake(addr, n);
+}
@@ -1,6 +1,8 @@
 #define NPROC        64  // maximum number of processes
 #define KSTACKSIZE 4096  // size of per-process kernel stack
 #define NCPU          8  // maximum number of CPUs
+#define NWAITQ       61  // number of sleep channel hash buckets
+#define GANGSLICE     2  // gang scheduling time slice (ticks)
 #define NOFILE       16  // open files per process
 #define NFILE       100  // open files per system
 #define NINODE       50  // maximum number of active i-nodes
@@ -4,27 +4,211 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "x86.h"
-#include "proc.h"
+#include "rusage.h"
 #include "spinlock.h"
+#include "proc.h"
+#include "traps.h"
 
-struct {
+// chan으로 hash한 sleeping process들의 wait queue
+struct waitqueue {
   struct spinlock lock;
+  struct proc *head;
+};
+
+// 전역 lock은 process마다 있는 p->lock 외에 아래 것들만 있음
+// lock을 여러 개 잡을 때는 wait_lock -> p->lock -> wait queue lock 순서로 잡음
+// (wakeup()은 wait queue lock을 놓은 뒤에 p->lock을 잡음)
+struct {
   struct proc proc[NPROC];
+  struct waitqueue waitq[NWAITQ];
 } ptable;
 
 static struct proc *initproc;
 
 int nextpid = 1;
 int nexttid = 1;
+struct spinlock pid_lock;      // nextpid, nexttid를 보호
+
+// parent, called 관계를 보호하고, wait()과 thread_join()이 잠들 때 쓰는 lock
+// 부모가 wait()에서 자식의 종료를 놓치지 않게 함
+struct spinlock wait_lock;
+
 extern void forkret(void);
 extern void trapret(void);
 
-static void wakeup1(void *chan);
+// chan이 속한 wait queue를 반환하는 함수
+static struct waitqueue*
+waitq(void *chan)
+{
+  return &ptable.waitq[(uint)chan % NWAITQ];
+}
+
+// 잠들려는 p를 p->chan의 wait queue에 넣는 함수
+// p->lock을 잡은 상태에서 호출해야 함
+static void
+waitq_insert(struct proc *p)
+{
+  struct waitqueue *q = waitq(p->chan);
+
+  acquire(&q->lock);
+  p->wq = q;
+  p->wq_prev = 0;
+  p->wq_next = q->head;
+  if(q->head)
+    q->head->wq_prev = p;
+  q->head = p;
+  release(&q->lock);
+}
+
+// p가 들어있는 wait queue에서 p를 빼는 함수 (q->lock을 잡은 상태에서 호출)
+static void
+waitq_unlink(struct waitqueue *q, struct proc *p)
+{
+  if(p->wq_prev)
+    p->wq_prev->wq_next = p->wq_next;
+  else
+    q->head = p->wq_next;
+  if(p->wq_next)
+    p->wq_next->wq_prev = p->wq_prev;
+  p->wq = 0;
+  p->wq_next = 0;
+  p->wq_prev = 0;
+}
+
+// p가 아직 wait queue에 들어있다면 빼는 함수
+// p->lock을 잡은 상태에서 호출해야 함
+static void
+waitq_remove(struct proc *p)
+{
+  struct waitqueue *q = p->wq;
+
+  if(q == 0)                   // wakeup()이 이미 뺐음
+    return;
+  acquire(&q->lock);
+  if(p->wq == q)               // lock을 잡는 사이 wakeup()이 뺐을 수 있음
+    waitq_unlink(q, p);
+  release(&q->lock);
+}
+
+// 새 pid를 할당하는 함수
+static int
+allocpid(void)
+{
+  int pid;
+
+  acquire(&pid_lock);
+  pid = nextpid++;
+  release(&pid_lock);
+  return pid;
+}
+
+// src의 CPU 사용량을 dst에 더하는 함수
+static void
+ruadd(struct rusage *dst, struct rusage *src)
+{
+  dst->utime += src->utime;
+  dst->stime += src->stime;
+  dst->nvcsw += src->nvcsw;
+  dst->nivcsw += src->nivcsw;
+  dst->nfault += src->nfault;
+}
+
+// 새로 RUNNABLE이 된 process를 실행하도록 멈춰 있는 cpu 하나를 IPI로 깨우는 함수
+// RUNNABLE로 바꾼 process의 p->lock을 잡은 상태에서 호출해야 함
+static void
+kickidle(void)
+{
+  struct cpu *c;
+
+  __sync_synchronize();        // RUNNABLE로 바꾼 것이 idle()의 마지막 확인보다 먼저 보이도록 함
+  for(c = cpus; c < &cpus[ncpu]; c++){
+    // 깨울 cpu의 idle을 먼저 지워서 이어지는 kickidle()이 다른 멈춘 cpu를 깨우게 함
+    if(c->idle && c != mycpu() && xchg((volatile uint*)&c->idle, 0)){
+      lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+      return;
+    }
+  }
+}
+
+// Gang scheduling.
+// setgang()을 켠 process의 thread가 dispatch 되면 GANGSLICE tick 동안 그 pid의 gang이 진행되고,
+// 그동안 모든 cpu는 그 pid의 RUNNABLE thread를 먼저 실행함
+// 다른 cpu들은 IPI를 받아 실행 중이던 다른 process를 yield하고 gang의 thread로 바꿈
+// 같은 pid가 gang을 연달아 시작하지는 못하게 해서 다른 process도 cpu를 나눠 쓰게 함
+struct {
+  struct spinlock lock;
+  int pid;                     // 진행 중이거나 마지막으로 진행된 gang의 pid (없으면 0)
+  uint end;                    // gang이 끝나는 tick
+} gang;
+
+// Address space.
+// process마다 mm이 하나씩 있으며, thread는 thread_create를 호출한 thread의 mm을 ref를 늘려 함께 씀
+// process 수만큼만 필요함 (exec은 새 mm을 만들지 않고 자신의 mm을 바꿈)
+// lock 순서는 wait_lock -> p->lock -> mm->lock, mmtable.lock은 ref를 바꿀 때만 잠깐 잡음
+struct {
+  struct spinlock lock;
+  struct mm mm[NPROC];
+} mmtable;
+
+// 진행 중인 gang의 pid를 반환하는 함수 (없으면 0)
+static int
+gang_pid(void)
+{
+  int pid = gang.pid;
+
+  if(pid && (int)(ticks - gang.end) >= 0)   // time slice가 끝났음
+    return 0;
+  return pid;
+}
+
+// gang인 p가 dispatch 될 때 진행 중인 gang이 없으면 p의 pid로 gang을 시작하는 함수
+// 다른 cpu들이 곧바로 p의 형제 thread를 실행하도록 IPI를 보냄
+// p->lock을 잡은 상태에서 호출해야 함
+static void
+gang_start(struct proc *p)
+{
+  struct cpu *c;
+
+  acquire(&gang.lock);
+  if(gang_pid() != 0 ||                          // 이미 진행 중인 gang이 있거나
+     (gang.pid == p->pid && ticks - gang.end < GANGSLICE)){ // 방금 끝난 gang이 p의 pid라면
+    release(&gang.lock);
+    return;
+  }
+  gang.pid = p->pid;
+  gang.end = ticks + GANGSLICE;
+  release(&gang.lock);
+  for(c = cpus; c < &cpus[ncpu]; c++)
+    if(c != mycpu() && c->started)
+      lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+}
+
+// 진행 중인 gang이 있는데 p가 그 gang이 아니면 1을 반환하는 함수
+// trap()에서 gang이 시작되었다는 IPI를 받았을 때 yield 할지 정함
+int
+gang_preempt(struct proc *p)
+{
+  int pid = gang_pid();
+
+  return pid != 0 && p->pid != pid;
+}
 
 void
 pinit(void)
 {
-  initlock(&ptable.lock, "ptable");
+  struct proc *p;
+  int i;
+
+  initlock(&pid_lock, "nextpid");
+  initlock(&wait_lock, "wait_lock");
+  initlock(&gang.lock, "gang");
+  for(i = 0; i < NPROC; i++)
+    initlock(&mmtable.mm[i].lock, "mm");
+  initlock(&mmtable.lock, "mmtable");
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    initlock(&p->lock, "proc");
+  for(i = 0; i < NWAITQ; i++)
+    initlock(&ptable.waitq[i].lock, "waitq");
 }
 
 // Must be called with interrupts disabled
@@ -34,38 +218,86 @@ cpuid() {
 }
 
 // Must be called with interrupts disabled to avoid the caller being
-// rescheduled between reading lapicid and running through the loop.
+// rescheduled to another cpu while using the result.
+// seginit()에서 %gs에 잡아둔 per-CPU segment에서 한 번에 읽음
 struct cpu*
 mycpu(void)
 {
-  int apicid, i;
-  
+  struct cpu *c;
+
   if(readeflags()&FL_IF)
     panic("mycpu called with interrupts enabled\n");
-  
-  apicid = lapicid();
-  // APIC IDs are not guaranteed to be contiguous. Maybe we should have
-  // a reverse map, or reserve a register to store &cpus[i].
-  for (i = 0; i < ncpu; ++i) {
-    if (cpus[i].apicid == apicid)
-      return &cpus[i];
-  }
-  panic("unknown apicid\n");
+  asm volatile("movl %%gs:0, %0" : "=r" (c));
+  return c;
 }
 
-// Disable interrupts so that we are not rescheduled
-// while reading proc from the cpu structure
+// 현재 cpu의 proc을 명령어 하나로 읽으므로 interrupt를 끌 필요가 없음
+// (읽은 뒤 다른 cpu로 옮겨져도 그 cpu의 proc은 여전히 이 process임)
 struct proc*
 myproc(void) {
-  struct cpu *c;
   struct proc *p;
-  pushcli();
-  c = mycpu();
-  p = c->proc;
-  popcli();
+
+  asm volatile("movl %%gs:4, %0" : "=r" (p));
   return p;
 }
 
+// 비어 있는 mm을 찾아 ref를 1로 하고 반환하는 함수 (없으면 0)
+// pgdir은 호출한 쪽에서 만들어 넣음
+static struct mm*
+mm_alloc(void)
+{
+  struct mm *mm;
+
+  acquire(&mmtable.lock);
+  for(mm = mmtable.mm; mm < &mmtable.mm[NPROC]; mm++)
+    if(mm->ref == 0)
+      goto found;
+  release(&mmtable.lock);
+  return 0;
+
+found:
+  mm->ref = 1;
+  release(&mmtable.lock);
+  mm->sz = 0;
+  mm->mem_limit = 0;
+  mm->ntstack = 0;
+  mm->pgdir = 0;
+  return mm;
+}
+
+// mm을 함께 쓰는 thread를 하나 늘리는 함수
+static struct mm*
+mm_dup(struct mm *mm)
+{
+  acquire(&mmtable.lock);
+  mm->ref++;
+  release(&mmtable.lock);
+  return mm;
+}
+
+// mm을 쓰던 proc가 놓는 함수, 마지막이었다면 page table을 해제함
+void
+mm_put(struct mm *mm)
+{
+  pde_t *pgdir;
+
+  acquire(&mmtable.lock);
+  if(mm->ref > 1){
+    mm->ref--;
+    release(&mmtable.lock);
+    return;
+  }
+  release(&mmtable.lock);
+
+  pgdir = mm->pgdir;             // ref가 1이므로 다른 proc는 이 mm을 볼 수 없음
+  mm->pgdir = 0;
+  if(pgdir)
+    freevm(pgdir);
+  acquire(&mmtable.lock);
+  mm->ref = 0;                   // 해제를 마친 뒤에 비워야 mm_alloc이 가져가지 않음
+  release(&mmtable.lock);
+}
+
 //PAGEBREAK: 32
 // Look in the process table for an UNUSED proc.
 // If found, change state to EMBRYO and initialize
@@ -77,26 +309,32 @@ allocproc(void)
   struct proc *p;
   char *sp;
 
-  acquire(&ptable.lock);
-
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    acquire(&p->lock);
     if(p->state == UNUSED)
       goto found;
-
-  release(&ptable.lock);
+    release(&p->lock);
+  }
   return 0;
 
 found:
   p->state = EMBRYO;
-  p->pid = nextpid++;
-  p->mem_limit = 0;
+  p->pid = allocpid();
+  p->mm = 0;
   p->stack_size = 0;
   p->tid = 0;
   p->called = p;
   p->stack_start = 0;
   p->retval = 0;
+  memset(&p->ru, 0, sizeof(p->ru));
+  memset(&p->cru, 0, sizeof(p->cru));
+  p->fpu_used = 0;
+  p->fpu_cpu = 0;
+  p->gang = 0;
+  p->futex_pgdir = 0;
+  p->futex_next = 0;
 
-  release(&ptable.lock);
+  release(&p->lock);
 
   // Allocate kernel stack.
   if((p->kstack = kalloc()) == 0){
@@ -133,10 +371,10 @@ userinit(void)
   p = allocproc();
   
   initproc = p;
-  if((p->pgdir = setupkvm()) == 0)
+  if((p->mm = mm_alloc()) == 0 || (p->mm->pgdir = setupkvm()) == 0)
     panic("userinit: out of memory?");
-  inituvm(p->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
-  p->sz = PGSIZE;
+  inituvm(p->mm->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
+  p->mm->sz = PGSIZE;
   memset(p->tf, 0, sizeof(*p->tf));
   p->tf->cs = (SEG_UCODE << 3) | DPL_USER;
   p->tf->ds = (SEG_UDATA << 3) | DPL_USER;
@@ -153,43 +391,46 @@ userinit(void)
   // run this process. the acquire forces the above
   // writes to be visible, and the lock is also needed
   // because the assignment might not be atomic.
-  acquire(&ptable.lock);
+  acquire(&p->lock);
 
   p->state = RUNNABLE;
 
-  release(&ptable.lock);
+  release(&p->lock);
 }
 
 // Grow current process's memory by n bytes.
-// Return 0 on success, -1 on failure.
+// Return the old size on success, -1 on failure.
+// 같은 pid의 thread들은 mm을 함께 쓰므로 mm->sz 하나만 바꾸면 됨
 int
 growproc(int n)
 {
-  uint sz;
+  uint sz, oldsz;
   struct proc *curproc = myproc();
-  struct proc *p;
+  struct mm *mm = curproc->mm;
+  int i;
 
-  sz = curproc->sz;
-  if(curproc->mem_limit != 0 && sz + n > curproc->mem_limit) // 추가적으로 할당 받는 memory가 limit보다 크다면
-    return -1;
+  acquire(&mm->lock);
+  oldsz = sz = mm->sz;
+  if(mm->mem_limit != 0 && sz + n > mm->mem_limit) // 추가적으로 할당 받는 memory가 limit보다 크다면
+    goto bad;
   if(n > 0){
-    if((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
-      return -1;
+    if((sz = allocuvm(mm->pgdir, sz, sz + n)) == 0)
+      goto bad;
   } else if(n < 0){
-    if((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
-      return -1;
+    if((sz = deallocuvm(mm->pgdir, sz, sz + n)) == 0)
+      goto bad;
+    for(i = 0; i < mm->ntstack; i++)    // 해제된 영역에 걸친 stack은 다시 쓰면 안 됨
+      if(mm->tstack[i] + 2*PGSIZE > sz)
+        mm->tstack[i--] = mm->tstack[--mm->ntstack];
   }
-  
-  acquire(&ptable.lock);
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++) {
-    if(p->pid == curproc->pid) // 현재 pid와 같은 pid를 가졌다면
-      p->sz = sz;              // sz를 갱신
-  }
-  release(&ptable.lock);
-
-  curproc->sz = sz;
+  mm->sz = sz;
+  release(&mm->lock);
   switchuvm(curproc);
-  return 0;
+  return oldsz;
+
+bad:
+  release(&mm->lock);
+  return -1;
 }
 
 // Create a new process copying p as the parent.
@@ -208,18 +449,31 @@ fork(void)
   }
 
   // Copy process state from proc.
-  if((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0){
+  if((np->mm = mm_alloc()) == 0){
+    kfree(np->kstack);
+    np->kstack = 0;
+    np->state = UNUSED;
+    return -1;
+  }
+  acquire(&curproc->mm->lock);   // 복사하는 동안 다른 thread가 sz를 바꾸지 못하게 함
+  np->mm->pgdir = copyuvm(curproc->mm->pgdir, curproc->mm->sz);
+  np->mm->sz = curproc->mm->sz;
+  np->mm->ntstack = curproc->mm->ntstack; // 복사된 address space에서도 비어 있는 stack이므로 물려줌
+  memmove(np->mm->tstack, curproc->mm->tstack, sizeof(np->mm->tstack));
+  release(&curproc->mm->lock);
+  if(np->mm->pgdir == 0){
+    mm_put(np->mm);
+    np->mm = 0;
     kfree(np->kstack);
     np->kstack = 0;
     np->state = UNUSED;
     return -1;
   }
-  np->sz = curproc->sz;
-  np->parent = curproc;
   *np->tf = *curproc->tf;
 
   // Clear %eax so that fork returns 0 in the child.
   np->tf->eax = 0;
+  fpu_copy(np, curproc);         // 실행 중인 FPU 상태를 물려줌
 
   for(i = 0; i < NOFILE; i++)
     if(curproc->ofile[i])
@@ -230,11 +484,14 @@ fork(void)
 
   pid = np->pid;
 
-  acquire(&ptable.lock);
+  acquire(&wait_lock);
+  np->parent = curproc;
+  release(&wait_lock);
 
+  acquire(&np->lock);
   np->state = RUNNABLE;
-
-  release(&ptable.lock);
+  kickidle();
+  release(&np->lock);
 
   return pid;
 }
@@ -252,19 +509,27 @@ exit(void)
   if(curproc == initproc)
     panic("init exiting");
 
-  acquire(&ptable.lock);
+  futex_drop(curproc->mm->pgdir); // 정리할 형제 thread가 futex에서 기다리고 있었다면 뺌
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
-    if(p->pid == curproc->pid && p != curproc){ // pid가 같고 curproc이 아니라면
+    if(p == curproc)
+      continue;
+    acquire(&p->lock);
+    if(p->state != UNUSED && p->pid == curproc->pid){ // pid가 같고 curproc이 아니라면
+      ruadd(&curproc->ru, &p->ru);                    // 정리하는 thread의 사용량을 curproc에 더함
+      ruadd(&curproc->cru, &p->cru);
+      waitq_remove(p);                                // 잠들어 있던 thread는 wait queue에서 뺌
       kfree(p->kstack);
       p->kstack = 0;
+      mm_put(p->mm);                                  // curproc도 mm을 쓰므로 page table은 남음
+      p->mm = 0;
       p->pid = 0;
       p->parent = 0;
       p->name[0] = 0;
       p->killed = 0;
       p->state = UNUSED;
-    } // 자원 할당 해제 부분, wait()에서 해제한 것과 동일 (page table은 제외)
+    } // 자원 할당 해제 부분, wait()에서 해제한 것과 동일
+    release(&p->lock);
   }
-  release(&ptable.lock);
 
   // Close all open files.
   for(fd = 0; fd < NOFILE; fd++){
@@ -279,22 +544,24 @@ exit(void)
   end_op();
   curproc->cwd = 0;
 
-  acquire(&ptable.lock);
+  acquire(&wait_lock);
 
   // Parent might be sleeping in wait().
-  wakeup1(curproc->parent);
+  wakeup(curproc->parent);
 
   // Pass abandoned children to init.
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
     if(p->parent == curproc){
       p->parent = initproc;
-      if(p->state == ZOMBIE)
-        wakeup1(initproc);
+      wakeup(initproc);
     }
   }
 
   // Jump into the scheduler, never to return.
+  // wait_lock을 놓기 전에 ZOMBIE로 바꿔야 wait()이 잠들기 전에 이를 확인할 수 있음
+  acquire(&curproc->lock);
   curproc->state = ZOMBIE;
+  release(&wait_lock);
   sched();
   panic("zombie exit");
 }
@@ -308,7 +575,7 @@ wait(void)
   int havekids, pid;
   struct proc *curproc = myproc();
   
-  acquire(&ptable.lock);
+  acquire(&wait_lock);
   for(;;){
     // Scan through table looking for exited children.
     havekids = 0;
@@ -316,31 +583,112 @@ wait(void)
       if(p->parent != curproc)
         continue;
       havekids = 1;
+      acquire(&p->lock);
       if(p->state == ZOMBIE){
         // Found one.
         pid = p->pid;
+        ruadd(&curproc->cru, &p->ru);   // 자식과 자식이 회수한 자손들의 사용량을 더함
+        ruadd(&curproc->cru, &p->cru);
         kfree(p->kstack);
         p->kstack = 0;
-        freevm(p->pgdir);
+        mm_put(p->mm);
+        p->mm = 0;
         p->pid = 0;
         p->parent = 0;
         p->name[0] = 0;
         p->killed = 0;
         p->state = UNUSED;
-        release(&ptable.lock);
+        release(&p->lock);
+        release(&wait_lock);
         return pid;
       }
+      release(&p->lock);
     }
 
     // No point waiting if we don't have any children.
     if(!havekids || curproc->killed){
-      release(&ptable.lock);
+      release(&wait_lock);
       return -1;
     }
 
-    // Wait for children to exit.  (See wakeup1 call in proc_exit.)
-    sleep(curproc, &ptable.lock);  //DOC: wait-sleep
+    // Wait for children to exit.  (See wakeup call in exit.)
+    sleep(curproc, &wait_lock);  //DOC: wait-sleep
+  }
+}
+
+// 실행할 process가 없을 때 interrupt가 올 때까지 cpu c를 멈추는 함수
+// 멈추기 직전에 RUNNABLE process가 없는지 한 번 더 확인함
+// cpu 0은 ticks를 세야 하므로 timer를 그대로 두고, 나머지 cpu는 멈춰 있는 동안 timer를 끔
+static void
+idle(struct cpu *c)
+{
+  int tickless = cpuid() != 0;
+  struct proc *p;
+
+  cli();                  // hlt 전에 온 IPI를 놓치지 않도록 stihlt()까지 interrupt를 끔
+  c->idle = 1;
+  __sync_synchronize();   // kickidle()이 c->idle을 보거나, 여기서 RUNNABLE을 보거나 둘 중 하나는 성립
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->state == RUNNABLE){ // 확인 사이에 RUNNABLE이 된 process가 있으면 멈추지 않음
+      c->idle = 0;
+      sti();
+      return;
+    }
+  }
+  if(tickless)
+    lapictimer(0);
+  stihlt();               // interrupt나 다른 cpu의 IPI가 올 때까지 멈춤
+  if(tickless)
+    lapictimer(1);
+  c->idle = 0;
+}
+
+// cpu c에서 RUNNABLE인 p를 실행하고 p가 cpu를 내놓으면 돌아오는 함수
+// p->lock을 잡은 상태에서 호출해야 함
+static void
+run(struct cpu *c, struct proc *p)
+{
+  if(p->gang)               // gang이면 형제 thread들도 다른 cpu에서 같이 실행되게 함
+    gang_start(p);
+
+  // Switch to chosen process.  It is the process's job
+  // to release p->lock and then reacquire it
+  // before jumping back to us.
+  c->proc = p;
+  switchuvm(p);
+  fpu_switchin(p);
+  p->state = RUNNING;
+
+  swtch(&(c->scheduler), p->context);
+  switchkvm();
+
+  // Process is done running for now.
+  // It should have changed its p->state before coming back.
+  c->proc = 0;
+}
+
+// 진행 중인 gang이 있으면 그 pid의 RUNNABLE thread 하나를 실행하는 함수
+// 실행했으면 1, 실행할 thread가 없으면 0을 반환
+static int
+gang_run(struct cpu *c)
+{
+  struct proc *p;
+  int pid;
+
+  if((pid = gang_pid()) == 0)
+    return 0;
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->state != RUNNABLE || p->pid != pid)   // lock 없이 먼저 걸러냄
+      continue;
+    acquire(&p->lock);
+    if(p->state == RUNNABLE && p->pid == pid){
+      run(c, p);
+      release(&p->lock);
+      return 1;
+    }
+    release(&p->lock);
   }
+  return 0;
 }
 
 //PAGEBREAK: 42
@@ -356,38 +704,34 @@ scheduler(void)
 {
   struct proc *p;
   struct cpu *c = mycpu();
+  int ran;
   c->proc = 0;
   
   for(;;){
     // Enable interrupts on this processor.
     sti();
 
+    if(gang_run(c))           // 진행 중인 gang의 thread가 있으면 한 바퀴 돌기 전에 먼저 실행
+      continue;
+
     // Loop over process table looking for process to run.
-    acquire(&ptable.lock);
+    ran = 0;
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
-      if(p->state != RUNNABLE)
+      acquire(&p->lock);
+      if(p->state != RUNNABLE){
+        release(&p->lock);
         continue;
-
-      // Switch to chosen process.  It is the process's job
-      // to release ptable.lock and then reacquire it
-      // before jumping back to us.
-      c->proc = p;
-      switchuvm(p);
-      p->state = RUNNING;
-
-      swtch(&(c->scheduler), p->context);
-      switchkvm();
-
-      // Process is done running for now.
-      // It should have changed its p->state before coming back.
-      c->proc = 0;
+      }
+      ran = 1;
+      run(c, p);
+      release(&p->lock);
     }
-    release(&ptable.lock);
-
+    if(!ran)                // 실행할 process가 하나도 없었다면
+      idle(c);              // interrupt가 올 때까지 멈춤
   }
 }
 
-// Enter scheduler.  Must hold only ptable.lock
+// Enter scheduler.  Must hold only p->lock
 // and have changed proc->state. Saves and restores
 // intena because intena is a property of this
 // kernel thread, not this CPU. It should
@@ -400,15 +744,18 @@ sched(void)
   int intena;
   struct proc *p = myproc();
 
-  if(!holding(&ptable.lock))
-    panic("sched ptable.lock");
+  if(!holding(&p->lock))
+    panic("sched p->lock");
   if(mycpu()->ncli != 1)
     panic("sched locks");
   if(p->state == RUNNING)
     panic("sched running");
   if(readeflags()&FL_IF)
     panic("sched interruptible");
+  if(p->state == SLEEPING)   // 스스로 잠드는 경우는 자발적인 context switch
+    p->ru.nvcsw++;
   intena = mycpu()->intena;
+  fpu_switchout(p);          // 이번에 FPU를 썼다면 저장
   swtch(&p->context, mycpu()->scheduler);
   mycpu()->intena = intena;
 }
@@ -417,10 +764,12 @@ sched(void)
 void
 yield(void)
 {
-  acquire(&ptable.lock);  //DOC: yieldlock
-  myproc()->state = RUNNABLE;
+  struct proc *p = myproc();
+
+  acquire(&p->lock);  //DOC: yieldlock
+  p->state = RUNNABLE;
   sched();
-  release(&ptable.lock);
+  release(&p->lock);
 }
 
 // A fork child's very first scheduling by scheduler()
@@ -429,8 +778,8 @@ void
 forkret(void)
 {
   static int first = 1;
-  // Still holding ptable.lock from scheduler.
-  release(&ptable.lock);
+  // Still holding p->lock from scheduler.
+  release(&myproc()->lock);
 
   if (first) {
     // Some initialization functions must be run in the context
@@ -457,52 +806,64 @@ sleep(void *chan, struct spinlock *lk)
   if(lk == 0)
     panic("sleep without lk");
 
-  // Must acquire ptable.lock in order to
+  // Must acquire p->lock in order to
   // change p->state and then call sched.
-  // Once we hold ptable.lock, we can be
-  // guaranteed that we won't miss any wakeup
-  // (wakeup runs with ptable.lock locked),
+  // Once we hold p->lock and are on chan's
+  // wait queue, we can be guaranteed that we
+  // won't miss any wakeup (wakeup finds us on
+  // the queue and then waits for p->lock),
   // so it's okay to release lk.
-  if(lk != &ptable.lock){  //DOC: sleeplock0
-    acquire(&ptable.lock);  //DOC: sleeplock1
-    release(lk);
-  }
-  // Go to sleep.
+  acquire(&p->lock);  //DOC: sleeplock1
   p->chan = chan;
+  waitq_insert(p);
+  release(lk);
+
+  // Go to sleep.
   p->state = SLEEPING;
 
   sched();
 
   // Tidy up.
+  waitq_remove(p);    // kill()로 깨어났다면 아직 wait queue에 남아 있음
   p->chan = 0;
 
   // Reacquire original lock.
-  if(lk != &ptable.lock){  //DOC: sleeplock2
-    release(&ptable.lock);
-    acquire(lk);
-  }
+  release(&p->lock);
+  acquire(lk);
 }
 
 //PAGEBREAK!
 // Wake up all processes sleeping on chan.
-// The ptable lock must be held.
-static void
-wakeup1(void *chan)
-{
-  struct proc *p;
-
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if(p->state == SLEEPING && p->chan == chan)
-      p->state = RUNNABLE;
-}
-
-// Wake up all processes sleeping on chan.
+// Must be called without any p->lock.
 void
 wakeup(void *chan)
 {
-  acquire(&ptable.lock);
-  wakeup1(chan);
-  release(&ptable.lock);
+  struct waitqueue *q = waitq(chan);
+  struct proc *woken[NPROC];
+  struct proc *p, *next;
+  int i, n = 0;
+
+  // chan의 wait queue에서 깨울 process들을 먼저 빼 둠
+  acquire(&q->lock);
+  for(p = q->head; p; p = next){          // chan의 wait queue에 있는 process만 확인
+    next = p->wq_next;
+    if(p->chan == chan){                  // hash가 겹친 다른 chan의 process는 그대로 둠
+      waitq_unlink(q, p);
+      woken[n++] = p;
+    }
+  }
+  release(&q->lock);
+
+  // wait queue lock을 놓은 뒤에 각 process의 lock을 잡고 깨움
+  for(i = 0; i < n; i++){
+    p = woken[i];
+    acquire(&p->lock);
+    if(p->state == SLEEPING && p->chan == chan){
+      p->state = RUNNABLE;
+      kickidle();
+    }
+    release(&p->lock);
+  }
 }
 
 // Kill the process with the given pid.
@@ -513,18 +874,21 @@ kill(int pid)
 {
   struct proc *p;
 
-  acquire(&ptable.lock);
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
-    if(p->pid == pid && p->tid == 0){
+    acquire(&p->lock);
+    if(p->state != UNUSED && p->pid == pid && p->tid == 0){
       p->killed = 1;
       // Wake process from sleep if necessary.
-      if(p->state == SLEEPING)
+      // wait queue에서는 깨어난 process가 sleep()에서 스스로 빠짐
+      if(p->state == SLEEPING){
         p->state = RUNNABLE;
-      release(&ptable.lock);
+        kickidle();
+      }
+      release(&p->lock);
       return 0;
     }
+    release(&p->lock);
   }
-  release(&ptable.lock);
   return -1;
 }
 
@@ -573,22 +937,20 @@ setmemorylimit(int pid, int limit)
     return -1;
   struct proc *p;
 
-  acquire(&ptable.lock);
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){ // ptable 처음부터 끝까지 순회
-    if(p->pid == pid){ // pid가 같으면
-      if(limit == 0){ // limit가 0이면
-        p->mem_limit = 0; // mem_limit에 0을 넣음
-        release(&ptable.lock);
-        return 0;
-      }
-      if(limit >= p->sz){ // 기존에 할당 받은 메모리보다 limit가 크면
-        p->mem_limit = limit; // mem_limit에 limit를 넣음
-        release(&ptable.lock);
+    acquire(&p->lock);
+    if(p->state != UNUSED && p->pid == pid && p->mm){ // pid가 같으면 (같은 pid의 thread들은 mm을 함께 씀)
+      acquire(&p->mm->lock);
+      if(limit == 0 || limit >= p->mm->sz){ // limit가 0이거나 기존에 할당 받은 메모리보다 크면
+        p->mm->mem_limit = limit; // mem_limit에 limit를 넣음
+        release(&p->mm->lock);
+        release(&p->lock);
         return 0;
       }
+      release(&p->mm->lock);
     }
+    release(&p->lock);
   }
-  release(&ptable.lock);
   return -1;
 }
 
@@ -608,17 +970,17 @@ printlist()
 {
   struct proc *p;
 
-  acquire(&ptable.lock);
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){ // ptable 처음부터 끝까지 순회
+    acquire(&p->lock);
     if(p->state == RUNNABLE || p->state == RUNNING || p->state == SLEEPING){ // 현재 실행 중인 process라면
       cprintf("name: %s, pid: %d, pages for stack: %d\n", p->name, p->pid, p->stack_size);
-      if (p->mem_limit == 0)                          // mem_limit이 0이면
-        cprintf("memory size: %d, memory limit: unlimited\n", p->sz);
+      if (p->mm->mem_limit == 0)                      // mem_limit이 0이면
+        cprintf("memory size: %d, memory limit: unlimited\n", p->mm->sz);
       else                                            // mem_limit이 0이 아니면
-        cprintf("memory size: %d, memory limit: %d\n", p->sz, p->mem_limit);
+        cprintf("memory size: %d, memory limit: %d\n", p->mm->sz, p->mm->mem_limit);
     }
+    release(&p->lock);
   }
-  release(&ptable.lock);
 }
 
 // printlist 함수의 system call 함수
@@ -629,29 +991,58 @@ sys_printlist(void)
   return 0;
 }
 
+// mm에 모아 둔 stack 중 가장 아래 것을 꺼내 시작 주소를 반환하는 함수 (없으면 0)
+// 위쪽 stack을 남겨 두어야 thread_stack_trim()이 sz를 줄일 수 있음
+// mm->lock을 잡은 상태에서 호출해야 함
+static uint
+tstack_get(struct mm *mm)
+{
+  uint start;
+  int i, found = 0;
+
+  if(mm->ntstack == 0)
+    return 0;
+  for(i = 1; i < mm->ntstack; i++)
+    if(mm->tstack[i] < mm->tstack[found])
+      found = i;
+  start = mm->tstack[found];
+  mm->tstack[found] = mm->tstack[--mm->ntstack];
+  return start;
+}
+
+// 더 이상 쓰지 않는 start 위치의 stack을 mm에 모아 두는 함수
+// mm->lock을 잡은 상태에서 호출해야 함
+static void
+tstack_put(struct mm *mm, uint start)
+{
+  if(mm->ntstack < NPROC)      // thread 수가 NPROC을 넘지 않으므로 항상 자리가 있음
+    mm->tstack[mm->ntstack++] = start;
+}
+
 // 새 스레드를 생성하고 시작하는 함수
 int
 thread_create(thread_t *thread, void *(*start_routine)(void *), void *arg)
 {
   int i;
   struct proc *np;
-  struct proc *p;
   struct proc *curproc = myproc();
-  uint sz, sp, ustack[2];
+  struct mm *mm = curproc->mm;
+  uint sz, sp, ustack[2], start = 0;
 
   // fork에서 변형
   if((np = allocproc()) == 0){ // 새로운 thread를 위한 공간을 np에 할당
     return -1;                 // 종료
   }
 
-  if(curproc->pgdir == 0){ // 현재 curproc의 page directory가 0이면
+  if(mm == 0){             // 현재 curproc의 address space가 없으면
     np->state = UNUSED;    // 상태를 UNUSED로 바꾸고
     return -1;             // 종료
   }
-  np->parent = curproc->parent; // 새로운 thread의 parent를 현재 curproc의 parent로 설정
   *np->tf = *curproc->tf;       // 새로운 thread의 trap frame을 현재 curproc의 trap frame으로 설정
 
   np->tf->eax = 0;  // Clear %eax so that fork returns 0 in the child.
+  fpu_copy(np, curproc);  // 새로운 thread도 FPU 상태(control word 등)를 물려받음
+  np->gang = curproc->gang;  // 같은 pid의 thread는 gang 설정을 공유함
 
   for(i = 0; i < NOFILE; i++)                    // 0부터 file table의 최대 크기까지
     if(curproc->ofile[i])                        // file table에서 해당 file이 비어있지 않으면
@@ -660,54 +1051,60 @@ thread_create(thread_t *thread, void *(*start_routine)(void *), void *arg)
 
   safestrcpy(np->name, curproc->name, sizeof(curproc->name)); // 새로운 thread의 name을 현재 curproc의 name으로 설정
 
-  acquire(&ptable.lock);
-  
-  np->pid = curproc->pid; // np의 pid를 현재 curproc의 pid로 설정
+  acquire(&wait_lock);
+  np->parent = curproc->parent; // 새로운 thread의 parent를 현재 curproc의 parent로 설정
+  np->called = curproc;         // thread_create를 호출한 curproc의 정보 저장
+  release(&wait_lock);
 
+  acquire(&pid_lock);
   np->tid = nexttid++;    // np의 tid를 설정
+  release(&pid_lock);
 
-  np->called = curproc;   // thread_create를 호출한 curproc의 정보 저장
-
-  release(&ptable.lock);
+  acquire(&np->lock);
+  np->pid = curproc->pid; // np의 pid를 현재 curproc의 pid로 설정
+  release(&np->lock);
 
   // stack 수정 부분 (exec에서 살짝 변형)
-  sz = curproc->sz; // sz에 현재 curproc의 sz를 할당
-
-  if((sz = allocuvm(curproc->pgdir, sz, sz + 2*PGSIZE)) == 0) // 2만큼의 가상 메모리 공간을 할당
-    goto bad;
-  clearpteu(curproc->pgdir, (char*)(sz - 2*PGSIZE));          // 가드용 페이지를 설정
-  sp = sz; // stack pointer에 sz를 할당
+  acquire(&mm->lock);
+  if((start = tstack_get(mm)) == 0){ // join된 thread의 stack이 남아 있지 않으면 새로 할당
+    if((sz = allocuvm(mm->pgdir, mm->sz, mm->sz + 2*PGSIZE)) == 0){ // 2만큼의 가상 메모리 공간을 할당
+      release(&mm->lock);
+      goto bad;
+    }
+    start = sz - 2*PGSIZE;
+    clearpteu(mm->pgdir, (char*)start); // 가드용 페이지를 설정
+    mm->sz = sz;                        // 모든 thread가 mm을 함께 쓰므로 한 번만 바꾸면 됨
+  }
+  release(&mm->lock);
+  sp = start + 2*PGSIZE; // stack pointer에 stack의 끝을 할당
 
   ustack[0] = 0xffffffff;  // fake return PC
   ustack[1] = (uint)arg;   // 받은 인자를 저장
 
   sp -= 2*4; // sp를 2칸 감소
-  if(copyout(curproc->pgdir, sp, ustack, 2*4) < 0) // ustack의 data를 pgdir에 복사함
+  if(copyout(mm->pgdir, sp, ustack, 2*4) < 0) // ustack의 data를 pgdir에 복사함
     goto bad;
 
-  np->stack_start = sz - 2*PGSIZE; // np의 stack의 시작 위치를 저장
-  curproc->sz = sz;                // 현재 curproc의 sz에 바뀐 sz 값을 할당
-  
-  np->sz = sz;                       // np의 sz에 sz 값을 할당
-  np->pgdir = curproc->pgdir;        // np의 pgdir에 현재 curproc의 pgdir를 할당
+  np->stack_start = start;           // np의 stack의 시작 위치를 저장
+  np->mm = mm_dup(mm);               // np는 현재 curproc의 address space를 함께 씀
   np->tf->eip = (uint)start_routine; // instruction pointer에 start_routine를 저장
   np->tf->esp = sp;                  // stack pointer에 sp를 담음
 
   *thread = np->tid;                 // thread에 np의 tid를 넣음
 
-  acquire(&ptable.lock);
-
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if(p->pid == curproc->pid) // 현재 pid와 같은 pid를 가졌다면
-      p->sz = sz;              // sz를 갱신
-  
+  acquire(&np->lock);
 	np->state = RUNNABLE;              // np의 상태를 RUNNABLE로 설정
-
-	release(&ptable.lock);
+  kickidle();                        // 멈춰 있는 cpu가 있으면 깨움
+	release(&np->lock);
 
   return 0;
 
  bad:
+  if(start){                         // 꺼내거나 할당한 stack은 다음 thread_create가 쓰게 함
+    acquire(&mm->lock);
+    tstack_put(mm, start);
+    release(&mm->lock);
+  }
   np->state = UNUSED;                // np의 상태를 UNUSED로 설정
   return -1;
 }
@@ -748,13 +1145,15 @@ thread_exit(void *retval)
   end_op(); // file system 동기화를 종료
   curproc->cwd = 0; // 참조한 값 초기화
 
-  acquire(&ptable.lock);
+  acquire(&wait_lock);
 
   // Parent might be sleeping in wait().
-  wakeup1(curproc->called); // exit()하려는 curproc을 호출한 called를 wakeup
+  wakeup(curproc->called); // exit()하려는 curproc을 호출한 called를 wakeup
 
   // Jump into the scheduler, never to return.
+  acquire(&curproc->lock);
   curproc->state = ZOMBIE; // 상태를 ZOMBIE로 설정
+  release(&wait_lock);     // ZOMBIE로 바꾼 뒤에 놓아야 thread_join이 이를 놓치지 않음
   sched();
   panic("zombie exit");
 }
@@ -779,7 +1178,7 @@ thread_join(thread_t thread, void **retval)
   int havekids;
   struct proc *curproc = myproc();
   
-  acquire(&ptable.lock);
+  acquire(&wait_lock);
   for(;;){
     // Scan through table looking for exited children.
     havekids = 0;
@@ -787,8 +1186,11 @@ thread_join(thread_t thread, void **retval)
       if(p->called != curproc || p->tid != thread) // p을 호출한 called가 curproc이 아니거나, tid가 thread가 아닌 경우
         continue;
       havekids = 1;
+      acquire(&p->lock);
       if(p->state == ZOMBIE){ // 상태가 ZOMBIE인 경우
         // Found one.
+        ruadd(&curproc->ru, &p->ru);   // 종료된 thread의 사용량을 join한 thread에 더함
+        ruadd(&curproc->cru, &p->cru);
         kfree(p->kstack);
         p->kstack = 0;
         p->pid = 0;
@@ -799,21 +1201,29 @@ thread_join(thread_t thread, void **retval)
         // 기존의 각종 초기화 + 새로 만든 값 초기화
         p->called = 0;
         p->tid = 0;
+        acquire(&p->mm->lock);
+        if(p->stack_start)                        // 다음 thread_create가 stack을 다시 쓰게 함
+          tstack_put(p->mm, p->stack_start);
+        release(&p->mm->lock);
+        mm_put(p->mm);                            // curproc가 mm을 쓰고 있으므로 page table은 남음
+        p->mm = 0;
         p->stack_start = 0;
         *retval = p->retval; // retval에 p에 넣어놨던 retval 값을 할당
-        release(&ptable.lock);
+        release(&p->lock);
+        release(&wait_lock);
         return 0;
       }
+      release(&p->lock);
     }
 
     // No point waiting if we don't have any children.
     if(!havekids || curproc->killed){
-      release(&ptable.lock);
+      release(&wait_lock);
       return -1;
     }
 
-    // Wait for children to exit.  (See wakeup1 call in proc_exit.)
-    sleep(curproc, &ptable.lock);  //DOC: wait-sleep
+    // Wait for children to exit.  (See wakeup call in thread_exit.)
+    sleep(curproc, &wait_lock);  //DOC: wait-sleep
   }
 }
 
@@ -828,23 +1238,144 @@ sys_thread_join(void)
   return thread_join((thread_t)thread, (void **)retval);
 }
 
+// 모아 둔 thread stack 중 sz 끝에 붙어 있는 것들을 실제로 돌려주고 줄어든 byte 수를 반환하는 함수
+// 중간에 있는 stack은 그 위가 쓰이고 있으므로 다음 thread_create에서 다시 쓰일 때까지 남겨 둠
+int
+thread_stack_trim(void)
+{
+  struct proc *curproc = myproc();
+  struct mm *mm = curproc->mm;
+  uint oldsz, sz;
+  int i;
+
+  acquire(&mm->lock);
+  oldsz = sz = mm->sz;
+  for(i = 0; i < mm->ntstack; i++){
+    if(mm->tstack[i] + 2*PGSIZE == sz){
+      sz = mm->tstack[i];
+      mm->tstack[i] = mm->tstack[--mm->ntstack];
+      i = -1;                  // 그 아래 stack이 새로 끝이 되었을 수 있으므로 처음부터 다시 찾음
+    }
+  }
+  if(sz != oldsz)
+    mm->sz = deallocuvm(mm->pgdir, oldsz, sz);
+  release(&mm->lock);
+  if(sz == oldsz)
+    return 0;
+  switchuvm(curproc);
+  return oldsz - sz;
+}
+
+// thread_stack_trim 함수의 system call 함수
+int
+sys_thread_stack_trim(void)
+{
+  return thread_stack_trim();
+}
+
 // exec에서 pid가 같으면서 tid가 다른 thread 정리하는 함수
 void
 exec_exit(int pid, int tid)
 {
   struct proc *p;
 
-  acquire(&ptable.lock);
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++) {
-    if(p->pid == pid && p->tid != tid) {
+    acquire(&p->lock);
+    if(p->state != UNUSED && p->pid == pid && p->tid != tid) {
+      ruadd(&myproc()->ru, &p->ru);   // 정리하는 thread의 사용량을 exec하는 thread에 더함
+      ruadd(&myproc()->cru, &p->cru);
+      waitq_remove(p);                // 잠들어 있던 thread는 wait queue에서 뺌
       kfree(p->kstack);
       p->kstack = 0;
+      mm_put(p->mm);                  // exec하는 thread가 mm을 쓰고 있으므로 page table은 남음
+      p->mm = 0;
       p->pid = 0;
       p->parent = 0;
       p->name[0] = 0;
       p->killed = 0;
       p->state = UNUSED;
     }
+    release(&p->lock);
   }
-  release(&ptable.lock);
-}
\ No newline at end of file
+}
+
+// exec이 만든 새 image (pgdir, sz)로 curproc의 address space를 바꾸는 함수
+// 형제 thread를 먼저 정리하므로 mm을 혼자 쓰는 상태에서 한 번에 바꿈
+void
+exec_commit(struct proc *curproc, pde_t *pgdir, uint sz)
+{
+  struct mm *mm = curproc->mm;
+  pde_t *oldpgdir = mm->pgdir;
+
+  futex_drop(oldpgdir);                  // 정리할 형제 thread가 이전 image의 futex에서 기다리고 있었다면 뺌
+  exec_exit(curproc->pid, curproc->tid); // pid가 같으면서 tid가 다른 thread 정리
+  acquire(&mm->lock);
+  mm->pgdir = pgdir;
+  mm->sz = sz;
+  mm->ntstack = 0;                       // 이전 image에 모아 둔 thread stack은 버림
+  release(&mm->lock);
+  fpu_reset(curproc);                    // 새 program은 초기 FPU 상태로 시작
+  switchuvm(curproc);
+  freevm(oldpgdir);
+}
+
+// 현재 process의 CPU 사용량을 ru에 채우는 함수
+// who가 RUSAGE_SELF이면 자신의, RUSAGE_CHILDREN이면 wait()로 회수한 자식들의 사용량
+// 같은 pid를 가진 모든 thread의 사용량을 합함
+int
+getrusage(int who, struct rusage *ru)
+{
+  struct proc *p;
+  struct proc *curproc = myproc();
+
+  if(who != RUSAGE_SELF && who != RUSAGE_CHILDREN)
+    return -1;
+  memset(ru, 0, sizeof(*ru));
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){ // ptable 처음부터 끝까지 순회
+    acquire(&p->lock);
+    if(p->state != UNUSED && p->pid == curproc->pid)  // 같은 process의 thread라면
+      ruadd(ru, who == RUSAGE_SELF ? &p->ru : &p->cru);
+    release(&p->lock);
+  }
+  return 0;
+}
+
+// getrusage 함수의 system call 함수
+int
+sys_getrusage(void)
+{
+  int who;
+  struct rusage *ru;
+
+  if(argint(0, &who) < 0 || argptr(1, (void*)&ru, sizeof(*ru)) < 0)
+    return -1;
+  return getrusage(who, ru);
+}
+
+// 현재 process와 같은 pid를 가진 모든 thread의 gang scheduling을 켜거나 (on이 0이 아니면) 끄는 함수
+// 켜져 있으면 한 thread가 dispatch 될 때 RUNNABLE인 형제 thread들도 다른 cpu에서 같은 time slice에 실행됨
+int
+setgang(int on)
+{
+  struct proc *p;
+  struct proc *curproc = myproc();
+
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){ // ptable 처음부터 끝까지 순회
+    acquire(&p->lock);
+    if(p->state != UNUSED && p->pid == curproc->pid)  // 같은 process의 thread라면
+      p->gang = (on != 0);
+    release(&p->lock);
+  }
+  return 0;
+}
+
+// setgang 함수의 system call 함수
+int
+sys_setgang(void)
+{
+  int on;
+
+  if(argint(0, &on) < 0)
+    return -1;
+  return setgang(on);
+}
@@ -7,7 +7,10 @@ struct cpu {
   volatile uint started;       // Has the CPU started?
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
-  struct proc *proc;           // The process running on this cpu or null
+  struct cpu *self;            // 이 cpu 자신, %gs:0 (proc 바로 앞에 있어야 함)
+  struct proc *proc;           // The process running on this cpu or null, %gs:4
+  volatile int idle;           // 할 일이 없어 hlt로 멈춰 있는지
+  struct proc *fpu_owner;      // 마지막으로 FPU register에 상태를 올린 process
 };
 
 extern struct cpu cpus[NCPU];
@@ -34,27 +37,58 @@ struct context {
 
 enum procstate { UNUSED, EMBRYO, SLEEPING, RUNNABLE, RUNNING, ZOMBIE };
 
+// 같은 pid의 thread들이 함께 쓰는 address space
+// fork와 userinit이 새로 만들고, thread_create는 ref만 늘려 나눠 씀
+// 마지막 thread가 놓을 때 page table을 해제함
+struct mm {
+  struct spinlock lock;        // sz, mem_limit, tstack을 보호 (pgdir은 exec에서만 바뀜)
+  int ref;                     // 이 mm을 쓰는 proc 수 (mmtable.lock으로 보호, 0이면 비어 있음)
+  pde_t* pgdir;                // Page table
+  uint sz;                     // Size of process memory (bytes)
+  int mem_limit;               // memory limit
+  uint tstack[NPROC];          // join된 thread의 stack (가드 page 시작 주소), 다음 thread_create가 다시 씀
+  int ntstack;                 // tstack에 모아 둔 stack 수
+};
+
 // Per-process state
 struct proc {
-  uint sz;                     // Size of process memory (bytes)
-  pde_t* pgdir;                // Page table
+  struct mm *mm;               // Address space (같은 pid의 thread들이 공유)
   char *kstack;                // Bottom of kernel stack for this process
+  struct spinlock lock;        // state, pid, chan, killed를 보호
+
+  // p->lock을 잡고 바꿔야 함
   enum procstate state;        // Process state
   int pid;                     // Process ID
+  void *chan;                  // If non-zero, sleeping on chan
+  int killed;                  // If non-zero, have been killed
+
+  // wait_lock을 잡고 바꿔야 함
   struct proc *parent;         // Parent process
+
+  // chan의 wait queue lock을 잡고 바꿔야 함
+  struct waitqueue *wq;        // 들어있는 wait queue (없으면 0)
+  struct proc *wq_next;        // 같은 wait queue에서 다음 process
+  struct proc *wq_prev;        // 같은 wait queue에서 이전 process
+
   struct trapframe *tf;        // Trap frame for current syscall
   struct context *context;     // swtch() here to run process
-  void *chan;                  // If non-zero, sleeping on chan
-  int killed;                  // If non-zero, have been killed
   struct file *ofile[NOFILE];  // Open files
   struct inode *cwd;           // Current directory
   char name[16];               // Process name (debugging)
-  int mem_limit;               // memory limit
   int stack_size;              // stacksize
   int tid;                     // thread ID
-  struct proc *called;         // thread_create를 호출한 proc
+  struct proc *called;         // thread_create를 호출한 proc (wait_lock으로 보호)
   uint stack_start;            // 자신의 stack 시작 위치
   void *retval;                // 스레드를 종료한 후 join 함수에서 받아갈 값
+  struct rusage ru;            // CPU 사용량
+  struct rusage cru;           // wait()로 회수한 자식들의 CPU 사용량 합
+  int gang;                    // 같은 pid의 thread들을 함께 실행할지 (setgang)
+  pde_t *futex_pgdir;          // futex_wait으로 기다리는 futex의 pgdir (기다리지 않으면 0)
+  uint futex_addr;             // futex_wait으로 기다리는 futex의 user 주소
+  struct proc *futex_next;     // 같은 futex bucket에서 다음 thread (futex.lock으로 보호)
+  int fpu_used;                // FPU를 쓴 적이 있어 fpu에 저장된 상태가 유효한지
+  struct cpu *fpu_cpu;         // 마지막으로 FPU 상태를 올린 cpu
+  uchar fpu[512] __attribute__((aligned(16))); // fxsave로 저장한 x87/SSE 상태
 };
 
 // Process memory is laid out contiguously, low addresses first:
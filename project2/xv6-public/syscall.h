@@ -25,4 +25,9 @@
 #define SYS_printlist 24
 #define SYS_thread_create 25
 #define SYS_thread_exit 26
-#define SYS_thread_join 27
\ No newline at end of file
+#define SYS_thread_join 27
+#define SYS_getrusage 28
+#define SYS_setgang 29
+#define SYS_futex_wait 30
+#define SYS_futex_wake 31
+#define SYS_thread_stack_trim 32
\ No newline at end of file
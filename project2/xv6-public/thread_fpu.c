@@ -0,0 +1,233 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "syscall.h"
+#include "traps.h"
+
+#define NUM_THREAD 4
+#define NUM_CHILD 2
+#define ROUNDS 20
+#define SPINS 2000000
+
+#define DEFAULT_CW 0x037f      // fninit 직후의 x87 control word
+#define DEFAULT_MXCSR 0x1f80   // 모든 SSE 예외를 mask 한 초기값
+#define TEST_CW 0x0c7f         // 반올림을 0 방향으로 바꾼 control word
+#define TEST_MXCSR 0x7f80      // 반올림을 0 방향으로 바꾼 MXCSR
+
+thread_t thread[NUM_THREAD];
+
+void failed()
+{
+  printf(1, "Test failed!\n");
+  exit();
+}
+
+// xmm0, st(0), st(1)에 seed로 만든 값을 넣고 spins번 계산한 뒤 sleep(ticks) 하고 다시 읽음
+// register를 쓰는 동안 C 코드가 끼어들지 않도록 system call도 asm 안에서 직접 부름
+// 값이 그대로면 0, 바뀌었으면 -1을 반환
+int fpu_hold(int seed, int spins, int ticks)
+{
+  int in[4], out[6], i, r;
+
+  for (i = 0; i < 4; i++)
+    in[i] = seed * 4 + i;
+  asm volatile("movups (%1), %%xmm0\n\t"
+               "fildl (%1)\n\t"
+               "fildl 4(%1)\n\t"
+               "movl %3, %%eax\n"
+               "1:\n\t"
+               "decl %%eax\n\t"
+               "jnz 1b\n\t"
+               "pushl %4\n\t"
+               "pushl $0\n\t"           // 가짜 return 주소 (argint은 esp+4부터 읽음)
+               "movl %5, %%eax\n\t"
+               "int %6\n\t"
+               "addl $8, %%esp\n\t"
+               "fistpl 20(%2)\n\t"
+               "fistpl 16(%2)\n\t"
+               "movups %%xmm0, (%2)"
+               : "=&a" (r)
+               : "r" (in), "r" (out), "r" (spins), "r" (ticks), "i" (SYS_sleep), "i" (T_SYSCALL)
+               : "memory", "cc");  // -m32에서 compiler는 xmm을 쓰지 않으며 clobber로 적을 수도 없음
+  for (i = 0; i < 4; i++)
+    if (out[i] != in[i])
+      return -1;
+  if (out[4] != in[0] || out[5] != in[1])
+    return -1;
+  return 0;
+}
+
+// 계산으로 선점되는 경우와 sleep으로 cpu를 내놓는 경우를 번갈아 반복함
+int fpu_rounds(int id)
+{
+  int i;
+
+  for (i = 0; i < ROUNDS; i++) {
+    if (fpu_hold(id * 1000 + i, SPINS, i % 2) < 0) {
+      printf(1, "Worker %d lost its FPU registers in round %d\n", id, i);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+void set_fpu_mode(ushort cw, uint mxcsr)
+{
+  asm volatile("fldcw %0\n\tldmxcsr %1" : : "m" (cw), "m" (mxcsr));
+}
+
+// control word와 MXCSR이 cw, mxcsr이면 0, 아니면 출력하고 -1을 반환
+int check_fpu_mode(char *who, ushort cw, uint mxcsr)
+{
+  ushort c;
+  uint m;
+
+  asm volatile("fnstcw %0\n\tstmxcsr %1" : "=m" (c), "=m" (m));
+  if (c != cw || m != mxcsr) {
+    printf(1, "%s has control word 0x%x and MXCSR 0x%x, expected 0x%x and 0x%x\n", who, c, m, cw, mxcsr);
+    return -1;
+  }
+  return 0;
+}
+
+void *thread_regs(void *arg)
+{
+  thread_exit((void *)fpu_rounds((int)arg));
+  return 0;
+}
+
+void test_regs()
+{
+  int i, fd[2], ret, ok = 0;
+  char c;
+
+  if (pipe(fd) < 0) {
+    printf(1, "pipe failed\n");
+    failed();
+  }
+  for (i = 0; i < NUM_CHILD; i++) {
+    if (fork() == 0) {
+      close(fd[0]);
+      if (fpu_rounds(NUM_THREAD + 1 + i) == 0)
+        write(fd[1], "k", 1);
+      exit();
+    }
+  }
+  close(fd[1]);
+  for (i = 0; i < NUM_THREAD; i++) {
+    if (thread_create(&thread[i], thread_regs, (void *)(i + 1)) != 0) {
+      printf(1, "Error creating thread %d\n", i);
+      failed();
+    }
+  }
+  if (fpu_rounds(0) < 0)
+    failed();
+  for (i = 0; i < NUM_THREAD; i++) {
+    if (thread_join(thread[i], (void **)&ret) != 0 || ret != 0) {
+      printf(1, "Thread %d failed\n", i);
+      failed();
+    }
+  }
+  while (read(fd[0], &c, 1) == 1)
+    ok++;
+  close(fd[0]);
+  for (i = 0; i < NUM_CHILD; i++)
+    wait();
+  if (ok != NUM_CHILD) {
+    printf(1, "%d of %d children kept their FPU registers\n", ok, NUM_CHILD);
+    failed();
+  }
+}
+
+void *thread_mode(void *arg)
+{
+  thread_exit((void *)check_fpu_mode("Thread", TEST_CW, TEST_MXCSR));
+  return 0;
+}
+
+void test_inherit()
+{
+  int pid, fd[2], ret;
+  char c;
+
+  set_fpu_mode(TEST_CW, TEST_MXCSR);
+  if (thread_create(&thread[0], thread_mode, 0) != 0 || thread_join(thread[0], (void **)&ret) != 0) {
+    printf(1, "Error running thread\n");
+    failed();
+  }
+  if (ret != 0)
+    failed();
+
+  if (pipe(fd) < 0) {
+    printf(1, "pipe failed\n");
+    failed();
+  }
+  if ((pid = fork()) == 0) {
+    close(fd[0]);
+    sleep(1);                  // 다른 process가 cpu의 FPU register를 쓴 뒤에도 물려받은 값이어야 함
+    if (check_fpu_mode("Forked child", TEST_CW, TEST_MXCSR) == 0)
+      write(fd[1], "k", 1);
+    exit();
+  }
+  close(fd[1]);
+  if (pid < 0 || read(fd[0], &c, 1) != 1)
+    failed();
+  close(fd[0]);
+  wait();
+  set_fpu_mode(DEFAULT_CW, DEFAULT_MXCSR);
+}
+
+void test_exec()
+{
+  int fd[2];
+  char c, fdstr[2];
+  char *args[4];
+
+  if (pipe(fd) < 0) {
+    printf(1, "pipe failed\n");
+    failed();
+  }
+  if (fork() == 0) {
+    close(fd[0]);
+    set_fpu_mode(TEST_CW, TEST_MXCSR);
+    fdstr[0] = '0' + fd[1];
+    fdstr[1] = 0;
+    args[0] = "thread_fpu";
+    args[1] = "exec";
+    args[2] = fdstr;
+    args[3] = 0;
+    exec("thread_fpu", args);
+    printf(1, "exec failed\n");
+    exit();
+  }
+  close(fd[1]);
+  if (read(fd[0], &c, 1) != 1)
+    failed();
+  close(fd[0]);
+  wait();
+}
+
+int main(int argc, char *argv[])
+{
+  // test_exec가 exec한 program: 초기 상태인지 확인하고 결과를 argv[2]의 fd로 알림
+  if (argc == 3 && strcmp(argv[1], "exec") == 0) {
+    if (check_fpu_mode("Exec'd program", DEFAULT_CW, DEFAULT_MXCSR) == 0)
+      write(atoi(argv[2]), "k", 1);
+    exit();
+  }
+
+  printf(1, "Test 1: FPU register test\n");
+  test_regs();
+  printf(1, "Test 1 passed\n\n");
+
+  printf(1, "Test 2: FPU mode inherit test\n");
+  test_inherit();
+  printf(1, "Test 2 passed\n\n");
+
+  printf(1, "Test 3: FPU exec reset test\n");
+  test_exec();
+  printf(1, "Test 3 passed\n\n");
+
+  printf(1, "All tests passed!\n");
+  exit();
+}
@@ -0,0 +1,528 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+#define NUM_THREAD 4
+#define PGSIZE 4096
+
+thread_t thread[NUM_THREAD];
+
+void failed()
+{
+  printf(1, "Test failed!\n");
+  exit();
+}
+
+void create_all(int n, void *(*entry)(void *))
+{
+  int i;
+  for (i = 0; i < n; i++) {
+    if (thread_create(&thread[i], entry, (void *)i) != 0) {
+      printf(1, "Error creating thread %d\n", i);
+      failed();
+    }
+  }
+}
+
+void join_all(int n)
+{
+  int i, retval;
+  for (i = 0; i < n; i++) {
+    if (thread_join(thread[i], (void **)&retval) != 0) {
+      printf(1, "Error joining thread %d\n", i);
+      failed();
+    }
+  }
+}
+
+volatile int fx;
+volatile int ready;
+int wait_ret[NUM_THREAD];
+
+void *thread_futex(void *arg)
+{
+  int val = (int)arg;
+
+  __sync_fetch_and_add(&ready, 1);
+  while (fx == 0)
+    wait_ret[val] = futex_wait((int *)&fx, 0, 0);
+  thread_exit(arg);
+  return 0;
+}
+
+void test_futex_wake()
+{
+  int i, n;
+
+  fx = 0;
+  ready = 0;
+  for (i = 0; i < NUM_THREAD; i++)
+    wait_ret[i] = 1;
+  create_all(NUM_THREAD, thread_futex);
+  while (ready < NUM_THREAD)
+    sleep(1);
+  sleep(10);
+  fx = 1;
+  n = futex_wake((int *)&fx, NUM_THREAD);
+  join_all(NUM_THREAD);
+  if (n != NUM_THREAD) {
+    printf(1, "futex_wake woke %d threads, expected %d\n", n, NUM_THREAD);
+    failed();
+  }
+  for (i = 0; i < NUM_THREAD; i++) {
+    if (wait_ret[i] != 0) {
+      printf(1, "futex_wait in thread %d returned %d, expected 0\n", i, wait_ret[i]);
+      failed();
+    }
+  }
+  if (futex_wake((int *)&fx, 1) != 0) {
+    printf(1, "futex_wake with no waiters woke someone\n");
+    failed();
+  }
+}
+
+void test_futex_timeout()
+{
+  int i, r, start;
+
+  fx = 0;
+  start = uptime();
+  if ((r = futex_wait((int *)&fx, 0, 5)) != -2) {
+    printf(1, "futex_wait with timeout returned %d, expected -2\n", r);
+    failed();
+  }
+  if (uptime() - start < 5) {
+    printf(1, "futex_wait timed out too early\n");
+    failed();
+  }
+  // 짧은 timeout은 잠들기 전에 지날 수 있으므로 여러 번 확인
+  for (i = 0; i < 20; i++) {
+    if ((r = futex_wait((int *)&fx, 0, 1)) != -2) {
+      printf(1, "futex_wait with 1 tick timeout returned %d, expected -2\n", r);
+      failed();
+    }
+  }
+}
+
+void test_futex_mismatch()
+{
+  int r;
+
+  fx = 7;
+  if ((r = futex_wait((int *)&fx, 0, 0)) != -1) {
+    printf(1, "futex_wait on changed value returned %d, expected -1\n", r);
+    failed();
+  }
+  if ((r = futex_wait((int *)((char *)&fx + 1), 7, 0)) != -1) {
+    printf(1, "futex_wait on unaligned address returned %d, expected -1\n", r);
+    failed();
+  }
+}
+
+#define ITER 2000
+#define ROUNDS 50
+#define TURNS 400
+
+thread_mutex_t m;
+thread_cond_t turn_cond;
+thread_barrier_t bar;
+thread_rwlock_t rw;
+int counter;
+int turn;
+int arrived[ROUNDS];
+int serial[ROUNDS];
+int rw_a, rw_b;
+
+// 임계 구역 안에서 선점될 기회를 늘리기 위해 잠시 계산함
+void delay(int n)
+{
+  volatile int i;
+  for (i = 0; i < n; i++)
+    ;
+}
+
+void *thread_stress(void *arg)
+{
+  int val = (int)arg;
+  int i, tmp, a, b;
+
+  // mutex: 보호하지 않으면 잃어버릴 증가를 일부러 나눠서 함
+  for (i = 0; i < ITER; i++) {
+    thread_mutex_lock(&m);
+    tmp = counter;
+    delay(50);
+    counter = tmp + 1;
+    thread_mutex_unlock(&m);
+  }
+
+  // barrier: 모두 도착하기 전에는 아무도 지나가면 안 됨
+  for (i = 0; i < ROUNDS; i++) {
+    thread_mutex_lock(&m);
+    arrived[i]++;
+    thread_mutex_unlock(&m);
+    if (thread_barrier_wait(&bar)) {
+      thread_mutex_lock(&m);
+      serial[i]++;
+      thread_mutex_unlock(&m);
+    }
+    if (arrived[i] != NUM_THREAD) {
+      printf(1, "Thread %d passed barrier %d with %d arrived\n", val, i, arrived[i]);
+      failed();
+    }
+  }
+
+  // condvar: turn을 차례대로 넘김
+  thread_mutex_lock(&m);
+  while (turn < TURNS) {
+    if (turn % NUM_THREAD != val) {
+      thread_cond_wait(&turn_cond, &m);
+      continue;
+    }
+    turn++;
+    thread_cond_broadcast(&turn_cond);
+  }
+  thread_mutex_unlock(&m);
+
+  // rwlock: writer가 바꾸는 두 값을 reader는 항상 같게 봐야 함
+  for (i = 0; i < ITER; i++) {
+    if (i % 10 == val) {
+      thread_rwlock_wrlock(&rw);
+      rw_a = i;
+      delay(50);
+      rw_b = i;
+      thread_rwlock_unlock(&rw);
+    } else {
+      thread_rwlock_rdlock(&rw);
+      a = rw_a;
+      b = rw_b;
+      thread_rwlock_unlock(&rw);
+      if (a != b) {
+        printf(1, "Thread %d read %d and %d under rwlock\n", val, a, b);
+        failed();
+      }
+    }
+  }
+
+  thread_exit(arg);
+  return 0;
+}
+
+void test_sync_stress()
+{
+  int i;
+
+  thread_mutex_init(&m);
+  thread_cond_init(&turn_cond);
+  thread_barrier_init(&bar, NUM_THREAD);
+  thread_rwlock_init(&rw);
+  counter = turn = rw_a = rw_b = 0;
+  memset(arrived, 0, sizeof(arrived));
+  memset(serial, 0, sizeof(serial));
+  create_all(NUM_THREAD, thread_stress);
+  join_all(NUM_THREAD);
+  if (counter != NUM_THREAD * ITER) {
+    printf(1, "Counter is %d, expected %d\n", counter, NUM_THREAD * ITER);
+    failed();
+  }
+  for (i = 0; i < ROUNDS; i++) {
+    if (serial[i] != 1) {
+      printf(1, "Barrier %d released %d last arrivers, expected 1\n", i, serial[i]);
+      failed();
+    }
+  }
+  if (turn != TURNS) {
+    printf(1, "Turn is %d, expected %d\n", turn, TURNS);
+    failed();
+  }
+}
+
+// 자신의 stack이 있는 page 번호를 반환하는 thread
+void *thread_stackpage(void *arg)
+{
+  int local;
+  thread_exit((void *)((uint)&local / PGSIZE));
+  return 0;
+}
+
+// thread 하나를 만들고 join해서 반환값을 돌려줌
+int run_one(void *(*entry)(void *))
+{
+  thread_t t;
+  int retval;
+
+  if (thread_create(&t, entry, 0) != 0) {
+    printf(1, "Error creating thread\n");
+    failed();
+  }
+  if (thread_join(t, (void **)&retval) != 0) {
+    printf(1, "Error joining thread\n");
+    failed();
+  }
+  return retval;
+}
+
+void test_stack_reuse()
+{
+  int i, page, trimmed;
+  char *sz;
+
+  page = run_one(thread_stackpage);
+  sz = sbrk(0);
+  for (i = 0; i < 10; i++) {
+    if (run_one(thread_stackpage) != page) {
+      printf(1, "Joined thread's stack was not reused\n");
+      failed();
+    }
+    if (sbrk(0) != sz) {
+      printf(1, "thread_create grew memory although a stack was free\n");
+      failed();
+    }
+  }
+  if ((trimmed = thread_stack_trim()) <= 0) {
+    printf(1, "thread_stack_trim released nothing\n");
+    failed();
+  }
+  if (sbrk(0) != sz - trimmed) {
+    printf(1, "thread_stack_trim released %d bytes but memory shrank by %d\n", trimmed, sz - (char *)sbrk(0));
+    failed();
+  }
+  if (thread_stack_trim() != 0) {
+    printf(1, "Second thread_stack_trim released memory again\n");
+    failed();
+  }
+}
+
+void test_stack_shrink()
+{
+  int i, page;
+  char *p;
+
+  // 맨 위에 stack이 남은 상태에서 memory를 줄였다가 heap으로 다시 늘림
+  run_one(thread_stackpage);
+  if (sbrk(-2 * PGSIZE) == (char *)-1 || (p = sbrk(2 * PGSIZE)) == (char *)-1) {
+    printf(1, "sbrk failed\n");
+    failed();
+  }
+  memset(p, 0x5a, 2 * PGSIZE);
+  page = run_one(thread_stackpage);
+  if (page >= (uint)p / PGSIZE && page < (uint)p / PGSIZE + 2) {
+    printf(1, "New thread's stack overlaps the heap\n");
+    failed();
+  }
+  for (i = 0; i < 2 * PGSIZE; i++) {
+    if (p[i] != 0x5a) {
+      printf(1, "Heap was overwritten by a thread stack\n");
+      failed();
+    }
+  }
+
+  // 맨 위에 남은 stack을 줄여 없앤 뒤 다시 늘리지 않고 바로 thread를 만듦
+  run_one(thread_stackpage);
+  if (sbrk(-2 * PGSIZE) == (char *)-1) {
+    printf(1, "sbrk failed\n");
+    failed();
+  }
+  run_one(thread_stackpage);
+}
+
+char *grown[NUM_THREAD];
+
+// sbrk로 늘린 영역에 자신의 번호를 쓰고, 모두 늘릴 때까지 기다린 뒤 다른 thread가 쓴 값을 확인
+void *thread_sbrk_shared(void *arg)
+{
+  int val = (int)arg;
+  int i;
+
+  __sync_fetch_and_add(&ready, 1);
+  while (ready < NUM_THREAD)
+    ;
+  if ((grown[val] = sbrk(PGSIZE)) == (char *)-1) {
+    printf(1, "Thread %d sbrk failed\n", val);
+    failed();
+  }
+  memset(grown[val], val + 1, PGSIZE);
+  thread_barrier_wait(&bar);
+  for (i = 0; i < NUM_THREAD; i++) {
+    if (grown[i][0] != i + 1 || grown[i][PGSIZE - 1] != i + 1) {
+      printf(1, "Thread %d cannot see memory grown by thread %d\n", val, i);
+      failed();
+    }
+  }
+  thread_exit(arg);
+  return 0;
+}
+
+void test_sbrk_shared()
+{
+  int i, j;
+  char *start, *end;
+
+  ready = 0;
+  thread_barrier_init(&bar, NUM_THREAD);
+  start = sbrk(0);
+  create_all(NUM_THREAD, thread_sbrk_shared);
+  join_all(NUM_THREAD);
+  end = sbrk(0);
+  // 동시에 늘렸어도 각자 다른 page를 받아야 함
+  for (i = 0; i < NUM_THREAD; i++) {
+    for (j = 0; j < i; j++) {
+      if (grown[i] == grown[j]) {
+        printf(1, "Threads %d and %d got the same sbrk region\n", j, i);
+        failed();
+      }
+    }
+    if (grown[i] < start || grown[i] + PGSIZE > end || grown[i][0] != i + 1) {
+      printf(1, "Memory grown by thread %d is not visible in the main thread\n", i);
+      failed();
+    }
+  }
+}
+
+volatile int stop;
+volatile int spins[NUM_THREAD];
+
+void *thread_gang(void *arg)
+{
+  int val = (int)arg;
+
+  while (!stop)
+    spins[val]++;
+  thread_exit(arg);
+  return 0;
+}
+
+void test_gang()
+{
+  int i, fd[2], pid, deadline, work = 0;
+
+  stop = 0;
+  for (i = 0; i < NUM_THREAD; i++)
+    spins[i] = 0;
+  if (pipe(fd) < 0) {
+    printf(1, "pipe failed\n");
+    failed();
+  }
+  deadline = uptime() + 50;
+  // gang이 아닌 process도 cpu를 받아야 함
+  if ((pid = fork()) == 0) {
+    close(fd[0]);
+    while (uptime() < deadline)
+      work++;
+    write(fd[1], &work, sizeof(work));
+    exit();
+  }
+  close(fd[1]);
+  setgang(1);
+  create_all(NUM_THREAD, thread_gang);
+  while (uptime() < deadline)
+    sleep(1);
+  stop = 1;
+  join_all(NUM_THREAD);
+  setgang(0);
+  if (read(fd[0], &work, sizeof(work)) != sizeof(work) || work == 0) {
+    printf(1, "Process outside the gang did not run\n");
+    failed();
+  }
+  close(fd[0]);
+  wait();
+  for (i = 0; i < NUM_THREAD; i++) {
+    if (spins[i] == 0) {
+      printf(1, "Gang thread %d did not run\n", i);
+      failed();
+    }
+  }
+}
+
+#define SHRINKS 20
+
+int * volatile shrink_addr;
+
+// main thread가 sbrk로 늘린 page의 futex에서 기다리다가, 그 page가 줄어 없어지면 -1을 받고 끝남
+// page를 직접 읽으면 안 되므로 값은 kernel만 읽게 함
+void *thread_futex_shrink(void *arg)
+{
+  int *addr, r, n = 0;
+
+  while ((addr = shrink_addr) == 0)
+    ;
+  while ((r = futex_wait(addr, 0, 1)) != -1) {
+    if (r != -2 && r != 0) {
+      printf(1, "futex_wait during shrink returned %d\n", r);
+      failed();
+    }
+    n++;
+  }
+  thread_exit((void *)n);
+  return 0;
+}
+
+void test_futex_shrink()
+{
+  int i, retval;
+  thread_t t;
+
+  for (i = 0; i < SHRINKS; i++) {
+    shrink_addr = 0;
+    // thread의 stack이 새 page 위에 놓이지 않도록 thread를 먼저 만듦
+    if (thread_create(&t, thread_futex_shrink, 0) != 0) {
+      printf(1, "Error creating thread\n");
+      failed();
+    }
+    if ((shrink_addr = (int *)sbrk(PGSIZE)) == (int *)-1) {
+      printf(1, "sbrk failed\n");
+      failed();
+    }
+    *shrink_addr = 0;
+    sleep(i % 3);
+    if (sbrk(-PGSIZE) == (char *)-1) {
+      printf(1, "sbrk failed\n");
+      failed();
+    }
+    if (thread_join(t, (void **)&retval) != 0) {
+      printf(1, "Error joining thread\n");
+      failed();
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  printf(1, "Test 1: Futex wake test\n");
+  test_futex_wake();
+  printf(1, "Test 1 passed\n\n");
+
+  printf(1, "Test 2: Futex timeout test\n");
+  test_futex_timeout();
+  printf(1, "Test 2 passed\n\n");
+
+  printf(1, "Test 3: Futex value mismatch test\n");
+  test_futex_mismatch();
+  printf(1, "Test 3 passed\n\n");
+
+  printf(1, "Test 4: Mutex, condvar, barrier and rwlock stress test\n");
+  test_sync_stress();
+  printf(1, "Test 4 passed\n\n");
+
+  printf(1, "Test 5: Stack reuse test\n");
+  test_stack_reuse();
+  printf(1, "Test 5 passed\n\n");
+
+  printf(1, "Test 6: Shrink then create test\n");
+  test_stack_shrink();
+  printf(1, "Test 6 passed\n\n");
+
+  printf(1, "Test 7: Shared sbrk test\n");
+  test_sbrk_shared();
+  printf(1, "Test 7 passed\n\n");
+
+  printf(1, "Test 8: Gang scheduling test\n");
+  test_gang();
+  printf(1, "Test 8 passed\n\n");
+
+  printf(1, "Test 9: Futex wait during heap shrink test\n");
+  test_futex_shrink();
+  printf(1, "Test 9 passed\n\n");
+
+  printf(1, "All tests passed!\n");
+  exit();
+}
@@ -3,10 +3,11 @@
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "rusage.h"
+#include "spinlock.h"
 #include "proc.h"
 #include "x86.h"
 #include "traps.h"
-#include "spinlock.h"
 
 // Interrupt descriptor table (shared by all CPUs).
 struct gatedesc idt[256];
@@ -48,14 +49,28 @@ trap(struct trapframe *tf)
 
   switch(tf->trapno){
   case T_IRQ0 + IRQ_TIMER:
+    if(myproc()){                    // 실행 중이던 process의 CPU 사용 시간 1 증가
+      if((tf->cs&3) == DPL_USER)
+        myproc()->ru.utime++;
+      else
+        myproc()->ru.stime++;
+    }
     if(cpuid() == 0){
       acquire(&tickslock);
       ticks++;
-      wakeup(&ticks);
+      timer_expire();                // 이번 tick에 만료된 timer만 처리
       release(&tickslock);
     }
     lapiceoi();
     break;
+  case T_IRQ0 + IRQ_WAKEUP:
+    lapiceoi();
+    break;
+  case T_DEVICE:
+    if(myproc() == 0 || (tf->cs&3) == 0)
+      panic("fpu in kernel");
+    fpu_trap();                      // CR0.TS가 켜진 뒤 처음 쓰는 FPU 명령어, 상태를 복원하고 다시 실행
+    return;
   case T_IRQ0 + IRQ_IDE:
     ideintr();
     lapiceoi();
@@ -87,6 +102,8 @@ trap(struct trapframe *tf)
       panic("trap");
     }
     // In user space, assume process misbehaved.
+    if(tf->trapno == T_PGFLT)
+      myproc()->ru.nfault++;
     cprintf("pid %d %s: trap %d err %d on cpu %d "
             "eip 0x%x addr 0x%x--kill proc\n",
             myproc()->pid, myproc()->name, tf->trapno,
@@ -103,8 +120,17 @@ trap(struct trapframe *tf)
   // Force process to give up CPU on clock tick.
   // If interrupts were on while locks held, would need to check nlock.
   if(myproc() && myproc()->state == RUNNING &&
-     tf->trapno == T_IRQ0+IRQ_TIMER)
+     tf->trapno == T_IRQ0+IRQ_TIMER){
+    myproc()->ru.nivcsw++;           // timer에 의한 비자발적인 context switch
     yield();
+  }
+
+  // 다른 process의 gang이 시작되었다는 IPI를 받으면 cpu를 내줌
+  if(myproc() && myproc()->state == RUNNING &&
+     tf->trapno == T_IRQ0+IRQ_WAKEUP && gang_preempt(myproc())){
+    myproc()->ru.nivcsw++;
+    yield();
+  }
 
   // Check if the process has been killed since we yielded
   if(myproc() && myproc()->killed && (tf->cs&3) == DPL_USER)
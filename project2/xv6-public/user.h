@@ -1,5 +1,31 @@
 struct stat;
 struct rtcdate;
+struct rusage;
+
+// usync.c에서 쓰는 동기화 도구들 (초기화 함수로 초기화한 뒤 사용)
+typedef struct {
+  volatile int state;          // 0: 풀림, 1: 잠김, 2: 잠겼고 기다리는 thread가 있을 수 있음
+  int spins;                   // 잠들기 전에 spin 할 횟수의 추정치
+} thread_mutex_t;
+
+typedef struct {
+  volatile int seq;            // signal, broadcast 할 때마다 1씩 증가
+} thread_cond_t;
+
+typedef struct {
+  thread_mutex_t lock;
+  thread_cond_t readers;       // writer가 끝나기를 기다리는 reader들
+  thread_cond_t writers;       // reader, writer가 끝나기를 기다리는 writer들
+  int nreader;                 // 들어와 있는 reader 수
+  int writer;                  // writer가 들어와 있으면 1
+  int wwait;                   // 기다리는 writer 수
+} thread_rwlock_t;
+
+typedef struct {
+  int count;                   // 모여야 하는 thread 수
+  volatile int waiting;        // 이번 phase에 도착한 thread 수
+  volatile int phase;          // 모두 도착할 때마다 1씩 증가
+} thread_barrier_t;
 
 // system calls
 int fork(void);
@@ -29,6 +55,11 @@ void printlist();
 int thread_create(thread_t *thread, void *(*start_routine)(void *), void *arg);
 void thread_exit(void *retval);
 int thread_join(thread_t thread, void **retval);
+int getrusage(int, struct rusage*);
+int setgang(int);
+int futex_wait(int*, int, int);
+int futex_wake(int*, int);
+int thread_stack_trim(void);
 
 // ulib.c
 int stat(const char*, struct stat*);
@@ -43,3 +74,19 @@ void* memset(void*, int, uint);
 void* malloc(uint);
 void free(void*);
 int atoi(const char*);
+
+// usync.c
+void thread_mutex_init(thread_mutex_t*);
+void thread_mutex_lock(thread_mutex_t*);
+int thread_mutex_trylock(thread_mutex_t*);
+void thread_mutex_unlock(thread_mutex_t*);
+void thread_cond_init(thread_cond_t*);
+void thread_cond_wait(thread_cond_t*, thread_mutex_t*);
+void thread_cond_signal(thread_cond_t*);
+void thread_cond_broadcast(thread_cond_t*);
+void thread_rwlock_init(thread_rwlock_t*);
+void thread_rwlock_rdlock(thread_rwlock_t*);
+void thread_rwlock_wrlock(thread_rwlock_t*);
+void thread_rwlock_unlock(thread_rwlock_t*);
+void thread_barrier_init(thread_barrier_t*, int);
+int thread_barrier_wait(thread_barrier_t*);
@@ -0,0 +1,221 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// thread 사이의 동기화 도구 (mutex, condition variable, reader-writer lock, barrier)
+// 모두 atomic 명령어로 user 공간에서 처리하고, 기다려야 할 때만 futex_wait/futex_wake로 kernel에 들어감
+
+#define MUTEX_SPIN_MAX 100     // mutex를 잠들기 전에 spin 해보는 최대 횟수
+#define WAKE_ALL 0x7fffffff    // futex_wake로 모두 깨울 때 넘기는 수
+
+// *addr을 newval로 바꾸고 원래 값을 반환
+static inline int
+xchg(volatile int *addr, int newval)
+{
+  int result;
+
+  asm volatile("lock; xchgl %0, %1" :
+               "+m" (*addr), "=a" (result) :
+               "1" (newval) :
+               "cc", "memory");
+  return result;
+}
+
+// *addr이 expected이면 newval로 바꾸고, 어느 경우든 원래 값을 반환
+static inline int
+cmpxchg(volatile int *addr, int expected, int newval)
+{
+  int result;
+
+  asm volatile("lock; cmpxchgl %2, %1" :
+               "=a" (result), "+m" (*addr) :
+               "r" (newval), "0" (expected) :
+               "cc", "memory");
+  return result;
+}
+
+// *addr에 v를 더하고 더하기 전의 값을 반환
+static inline int
+fetch_add(volatile int *addr, int v)
+{
+  asm volatile("lock; xaddl %0, %1" :
+               "+r" (v), "+m" (*addr) :
+               :
+               "cc", "memory");
+  return v;
+}
+
+// spin 하는 동안 다른 hyper-thread에게 양보
+static inline void
+cpu_relax(void)
+{
+  asm volatile("pause" ::: "memory");
+}
+
+// Mutex.
+// state가 0이면 풀림, 1이면 잠겼고 기다리는 thread 없음, 2면 잠겼고 기다리는 thread가 있을 수 있음
+// 경쟁이 있으면 바로 잠들지 않고 잠시 spin 해보며, spin 할 횟수는 지금까지 걸린 횟수에 맞춰 조절함
+
+void
+thread_mutex_init(thread_mutex_t *m)
+{
+  m->state = 0;
+  m->spins = 0;
+}
+
+int
+thread_mutex_trylock(thread_mutex_t *m)
+{
+  return cmpxchg(&m->state, 0, 1) == 0 ? 0 : -1;
+}
+
+void
+thread_mutex_lock(thread_mutex_t *m)
+{
+  int c, i, max;
+
+  if((c = cmpxchg(&m->state, 0, 1)) == 0)       // 경쟁이 없으면 바로 얻음
+    return;
+
+  max = m->spins * 2 + 10;
+  if(max > MUTEX_SPIN_MAX)
+    max = MUTEX_SPIN_MAX;
+  for(i = 0; i < max && c != 2; i++){           // 기다리는 thread가 없는 동안만 spin
+    cpu_relax();
+    if((c = cmpxchg(&m->state, 0, 1)) == 0){
+      m->spins += (i - m->spins) / 8;           // spin으로 얻었으면 다음 spin 횟수를 여기에 맞춤
+      return;
+    }
+  }
+  m->spins += (max - m->spins) / 8;
+
+  if(c != 2)                                    // 기다리는 thread가 있다고 표시하고 잠듦
+    c = xchg(&m->state, 2);
+  while(c != 0){
+    futex_wait((int*)&m->state, 2, 0);
+    c = xchg(&m->state, 2);
+  }
+}
+
+void
+thread_mutex_unlock(thread_mutex_t *m)
+{
+  if(xchg(&m->state, 0) == 2)                   // 기다리는 thread가 있었다면 하나를 깨움
+    futex_wake((int*)&m->state, 1);
+}
+
+// Condition variable.
+// signal, broadcast 할 때마다 seq를 늘리므로, mutex를 놓은 뒤 잠들기 전에 온 signal도 놓치지 않음
+
+void
+thread_cond_init(thread_cond_t *c)
+{
+  c->seq = 0;
+}
+
+void
+thread_cond_wait(thread_cond_t *c, thread_mutex_t *m)
+{
+  int seq = c->seq;
+
+  thread_mutex_unlock(m);
+  futex_wait((int*)&c->seq, seq, 0);
+  while(xchg(&m->state, 2) != 0)                // 깨어난 thread가 여럿일 수 있으므로 기다리는 상태로 다시 얻음
+    futex_wait((int*)&m->state, 2, 0);
+}
+
+void
+thread_cond_signal(thread_cond_t *c)
+{
+  fetch_add(&c->seq, 1);
+  futex_wake((int*)&c->seq, 1);
+}
+
+void
+thread_cond_broadcast(thread_cond_t *c)
+{
+  fetch_add(&c->seq, 1);
+  futex_wake((int*)&c->seq, WAKE_ALL);
+}
+
+// Reader-writer lock.
+// 여러 reader가 동시에 들어갈 수 있고, writer가 기다리고 있으면 새로 오는 reader는 기다림 (writer 우선)
+
+void
+thread_rwlock_init(thread_rwlock_t *rw)
+{
+  thread_mutex_init(&rw->lock);
+  thread_cond_init(&rw->readers);
+  thread_cond_init(&rw->writers);
+  rw->nreader = 0;
+  rw->writer = 0;
+  rw->wwait = 0;
+}
+
+void
+thread_rwlock_rdlock(thread_rwlock_t *rw)
+{
+  thread_mutex_lock(&rw->lock);
+  while(rw->writer || rw->wwait)
+    thread_cond_wait(&rw->readers, &rw->lock);
+  rw->nreader++;
+  thread_mutex_unlock(&rw->lock);
+}
+
+void
+thread_rwlock_wrlock(thread_rwlock_t *rw)
+{
+  thread_mutex_lock(&rw->lock);
+  rw->wwait++;
+  while(rw->writer || rw->nreader)
+    thread_cond_wait(&rw->writers, &rw->lock);
+  rw->wwait--;
+  rw->writer = 1;
+  thread_mutex_unlock(&rw->lock);
+}
+
+void
+thread_rwlock_unlock(thread_rwlock_t *rw)
+{
+  int was_writer;
+
+  thread_mutex_lock(&rw->lock);
+  if((was_writer = rw->writer) != 0)
+    rw->writer = 0;
+  else
+    rw->nreader--;
+  if(rw->wwait){                                // 기다리는 writer가 있으면 writer에게 먼저 넘김
+    if(rw->nreader == 0)
+      thread_cond_signal(&rw->writers);
+  } else if(was_writer)                         // reader는 writer가 있을 때만 기다리므로 이때만 깨움
+    thread_cond_broadcast(&rw->readers);
+  thread_mutex_unlock(&rw->lock);
+}
+
+// Barrier.
+// count개의 thread가 모두 도착하면 phase를 늘려 한꺼번에 깨움
+// 마지막으로 도착한 thread는 1, 나머지는 0을 반환
+
+void
+thread_barrier_init(thread_barrier_t *b, int count)
+{
+  b->count = count;
+  b->waiting = 0;
+  b->phase = 0;
+}
+
+int
+thread_barrier_wait(thread_barrier_t *b)
+{
+  int phase = b->phase;
+
+  if(fetch_add(&b->waiting, 1) == b->count - 1){
+    b->waiting = 0;                             // phase를 늘리기 전에 비워야 다음 번 도착이 섞이지 않음
+    fetch_add(&b->phase, 1);
+    futex_wake((int*)&b->phase, WAKE_ALL);
+    return 1;
+  }
+  while(b->phase == phase)
+    futex_wait((int*)&b->phase, phase, 0);
+  return 0;
+}
@@ -117,6 +117,14 @@ sti(void)
   asm volatile("sti");
 }
 
+// interrupt를 켜고 다음 interrupt가 올 때까지 cpu를 멈춤
+// sti 바로 다음 명령어까지는 interrupt가 들어오지 않으므로 그 사이에 온 interrupt도 놓치지 않음
+static inline void
+stihlt(void)
+{
+  asm volatile("sti; hlt");
+}
+
 static inline uint
 xchg(volatile uint *addr, uint newval)
 {
@@ -130,6 +138,64 @@ xchg(volatile uint *addr, uint newval)
   return result;
 }
 
+static inline uint
+rcr0(void)
+{
+  uint val;
+  asm volatile("movl %%cr0,%0" : "=r" (val));
+  return val;
+}
+
+static inline void
+lcr0(uint val)
+{
+  asm volatile("movl %0,%%cr0" : : "r" (val));
+}
+
+static inline uint
+rcr4(void)
+{
+  uint val;
+  asm volatile("movl %%cr4,%0" : "=r" (val));
+  return val;
+}
+
+static inline void
+lcr4(uint val)
+{
+  asm volatile("movl %0,%%cr4" : : "r" (val));
+}
+
+// CR0.TS를 끄는 함수, 이후 FPU 명령어가 T_DEVICE trap 없이 실행됨
+static inline void
+clts(void)
+{
+  asm volatile("clts");
+}
+
+// x87/SSE register를 16 byte로 정렬된 512 byte 영역 area에 저장
+static inline void
+fxsave(void *area)
+{
+  asm volatile("fxsave %0" : "=m" (*(char (*)[512])area));
+}
+
+// area에 저장된 x87/SSE register를 복원
+static inline void
+fxrstor(void *area)
+{
+  asm volatile("fxrstor %0" : : "m" (*(char (*)[512])area));
+}
+
+// x87과 SSE control/status register를 초기값으로 되돌림
+static inline void
+fpureset(void)
+{
+  uint mxcsr = 0x1f80;         // 모든 SSE 예외를 mask 한 초기값
+
+  asm volatile("fninit; ldmxcsr %0" : : "m" (mxcsr));
+}
+
 static inline uint
 rcr2(void)
 {
@@ -8,6 +8,7 @@ struct rtcdate;
 struct spinlock;
 struct sleeplock;
 struct stat;
+struct timer;
 struct superblock;
 
 // bio.c
@@ -78,6 +79,8 @@ int             lapicid(void);
 extern volatile uint*    lapic;
 void            lapiceoi(void);
 void            lapicinit(void);
+void            lapicipi(int, int);
+void            lapictimer(int);
 void            lapicstartap(uchar, uint);
 void            microdelay(int);
 
@@ -159,6 +162,9 @@ void            syscall(void);
 
 // timer.c
 void            timerinit(void);
+void            timer_add(struct timer*, uint, void (*)(void*), void*);
+void            timer_del(struct timer*);
+void            timer_expire(void);
 
 // trap.c
 void            idtinit(void);
@@ -6,20 +6,74 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "traps.h"
 
 struct {
   struct spinlock lock;
   struct proc proc[NPROC];
+  struct proc *waitq[NWAITQ];  // chan으로 hash한 sleeping process들의 wait queue
 } ptable;
 
 static struct proc *initproc;
 
+// chan이 속한 wait queue의 head를 반환하는 함수
+static struct proc**
+waitq(void *chan)
+{
+  return &ptable.waitq[(uint)chan % NWAITQ];
+}
+
+// SLEEPING이 되는 p를 p->chan의 wait queue에 넣는 함수
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+waitq_insert(struct proc *p)
+{
+  struct proc **head = waitq(p->chan);
+
+  p->wq_prev = 0;
+  p->wq_next = *head;
+  if(*head)
+    (*head)->wq_prev = p;
+  *head = p;
+}
+
+// 더 이상 SLEEPING이 아닌 p를 wait queue에서 빼는 함수
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+waitq_remove(struct proc *p)
+{
+  if(p->wq_prev)
+    p->wq_prev->wq_next = p->wq_next;
+  else
+    *waitq(p->chan) = p->wq_next;
+  if(p->wq_next)
+    p->wq_next->wq_prev = p->wq_prev;
+  p->wq_next = 0;
+  p->wq_prev = 0;
+}
+
 int nextpid = 1;
 extern void forkret(void);
 extern void trapret(void);
 
 static void wakeup1(void *chan);
 
+// 새로 RUNNABLE이 된 process를 실행하도록 멈춰 있는 cpu 하나를 IPI로 깨우는 함수
+// ptable.lock을 잡은 상태에서 호출해야 함
+static void
+kickidle(void)
+{
+  struct cpu *c;
+
+  for(c = cpus; c < &cpus[ncpu]; c++){
+    // 깨울 cpu의 idle을 먼저 지워서 이어지는 kickidle()이 다른 멈춘 cpu를 깨우게 함
+    if(c->idle && c != mycpu() && xchg((volatile uint*)&c->idle, 0)){
+      lapicipi(c->apicid, T_IRQ0 + IRQ_WAKEUP);
+      return;
+    }
+  }
+}
+
 void
 pinit(void)
 {
@@ -33,35 +87,26 @@ cpuid() {
 }
 
 // Must be called with interrupts disabled to avoid the caller being
-// rescheduled between reading lapicid and running through the loop.
+// rescheduled to another cpu while using the result.
+// seginit()에서 %gs에 잡아둔 per-CPU segment에서 한 번에 읽음
 struct cpu*
 mycpu(void)
 {
-  int apicid, i;
-  
+  struct cpu *c;
+
   if(readeflags()&FL_IF)
     panic("mycpu called with interrupts enabled\n");
-  
-  apicid = lapicid();
-  // APIC IDs are not guaranteed to be contiguous. Maybe we should have
-  // a reverse map, or reserve a register to store &cpus[i].
-  for (i = 0; i < ncpu; ++i) {
-    if (cpus[i].apicid == apicid)
-      return &cpus[i];
-  }
-  panic("unknown apicid\n");
+  asm volatile("movl %%gs:0, %0" : "=r" (c));
+  return c;
 }
 
-// Disable interrupts so that we are not rescheduled
-// while reading proc from the cpu structure
+// 현재 cpu의 proc을 명령어 하나로 읽으므로 interrupt를 끌 필요가 없음
+// (읽은 뒤 다른 cpu로 옮겨져도 그 cpu의 proc은 여전히 이 process임)
 struct proc*
 myproc(void) {
-  struct cpu *c;
   struct proc *p;
-  pushcli();
-  c = mycpu();
-  p = c->proc;
-  popcli();
+
+  asm volatile("movl %%gs:4, %0" : "=r" (p));
   return p;
 }
 
@@ -215,6 +260,7 @@ fork(void)
   acquire(&ptable.lock);
 
   np->state = RUNNABLE;
+  kickidle();
 
   release(&ptable.lock);
 
@@ -311,6 +357,25 @@ wait(void)
   }
 }
 
+// 실행할 process가 없을 때 interrupt가 올 때까지 cpu c를 멈추는 함수
+// ptable.lock을 잡은 상태로 호출하며, lock을 놓고 돌아옴
+// cpu 0은 ticks를 세야 하므로 timer를 그대로 두고, 나머지 cpu는 멈춰 있는 동안 timer를 끔
+static void
+idle(struct cpu *c)
+{
+  int tickless = cpuid() != 0;
+
+  c->idle = 1;
+  c->intena = 0;          // release()가 interrupt를 켜지 않게 해서 hlt 전에 온 IPI를 놓치지 않음
+  release(&ptable.lock);
+  if(tickless)
+    lapictimer(0);
+  stihlt();               // interrupt나 다른 cpu의 IPI가 올 때까지 멈춤
+  if(tickless)
+    lapictimer(1);
+  c->idle = 0;
+}
+
 //PAGEBREAK: 42
 // Per-CPU process scheduler.
 // Each CPU calls scheduler() after setting itself up.
@@ -324,6 +389,7 @@ scheduler(void)
 {
   struct proc *p;
   struct cpu *c = mycpu();
+  int ran;
   c->proc = 0;
   
   for(;;){
@@ -332,9 +398,11 @@ scheduler(void)
 
     // Loop over process table looking for process to run.
     acquire(&ptable.lock);
+    ran = 0;
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
       if(p->state != RUNNABLE)
         continue;
+      ran = 1;
 
       // Switch to chosen process.  It is the process's job
       // to release ptable.lock and then reacquire it
@@ -350,6 +418,10 @@ scheduler(void)
       // It should have changed its p->state before coming back.
       c->proc = 0;
     }
+    if(!ran){               // 실행할 process가 하나도 없었다면
+      idle(c);              // interrupt가 올 때까지 멈춤 (ptable.lock을 놓고 돌아옴)
+      continue;
+    }
     release(&ptable.lock);
 
   }
@@ -438,6 +510,7 @@ sleep(void *chan, struct spinlock *lk)
   // Go to sleep.
   p->chan = chan;
   p->state = SLEEPING;
+  waitq_insert(p);
 
   sched();
 
@@ -457,11 +530,16 @@ sleep(void *chan, struct spinlock *lk)
 static void
 wakeup1(void *chan)
 {
-  struct proc *p;
+  struct proc *p, *next;
 
-  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++)
-    if(p->state == SLEEPING && p->chan == chan)
+  for(p = *waitq(chan); p; p = next){     // chan의 wait queue에 있는 process만 확인
+    next = p->wq_next;
+    if(p->chan == chan){                  // hash가 겹친 다른 chan의 process는 그대로 둠
+      waitq_remove(p);
       p->state = RUNNABLE;
+      kickidle();
+    }
+  }
 }
 
 // Wake up all processes sleeping on chan.
@@ -486,8 +564,11 @@ kill(int pid)
     if(p->pid == pid){
       p->killed = 1;
       // Wake process from sleep if necessary.
-      if(p->state == SLEEPING)
+      if(p->state == SLEEPING){
+        waitq_remove(p);
         p->state = RUNNABLE;
+        kickidle();
+      }
       release(&ptable.lock);
       return 0;
     }
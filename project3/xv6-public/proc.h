@@ -7,7 +7,9 @@ struct cpu {
   volatile uint started;       // Has the CPU started?
   int ncli;                    // Depth of pushcli nesting.
   int intena;                  // Were interrupts enabled before pushcli?
-  struct proc *proc;           // The process running on this cpu or null
+  struct cpu *self;            // 이 cpu 자신, %gs:0 (proc 바로 앞에 있어야 함)
+  struct proc *proc;           // The process running on this cpu or null, %gs:4
+  volatile int idle;           // 할 일이 없어 hlt로 멈춰 있는지
 };
 
 extern struct cpu cpus[NCPU];
@@ -45,6 +47,8 @@ struct proc {
   struct trapframe *tf;        // Trap frame for current syscall
   struct context *context;     // swtch() here to run process
   void *chan;                  // If non-zero, sleeping on chan
+  struct proc *wq_next;        // 같은 wait queue에서 다음 process
+  struct proc *wq_prev;        // 같은 wait queue에서 이전 process
   int killed;                  // If non-zero, have been killed
   struct file *ofile[NOFILE];  // Open files
   struct inode *cwd;           // Current directory
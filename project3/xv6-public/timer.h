@@ -0,0 +1,10 @@
+// tick 단위로 만료되는 kernel timer
+// timer.c의 함수들은 모두 tickslock을 잡은 상태에서 호출해야 함
+struct timer {
+  uint expire;                 // 만료되는 tick
+  void (*fn)(void*);           // 만료되면 tickslock을 잡은 채로 호출되는 함수
+  void *arg;                   // fn에 넘기는 인자
+  struct timer *next;          // 같은 slot에서 다음 timer
+  struct timer *prev;          // 같은 slot에서 이전 timer
+  int pending;                 // timer wheel에 들어있으면 1
+};